@@ -0,0 +1,57 @@
+#!/bin/sh
+# bench.sh - Compares the default, release (-O2), lto (-O3 -flto) and pgo builds.
+# Each build is made in its own scratch copy of the tree, so the binaries here are left alone,
+# and plays the same number of turbo games (engine.o, see `make turbo`). The report gives,
+# averaged over the games:
+#
+#   rooms/s    - rooms per second of play, as engine.c reports it after every game
+#   barb/wiz   - how long the Barbarian and Wizard took to answer a room (ms)
+#   unlock     - how long the Rogue took to unlock a trap (ms)
+#   pick       - how long the Rogue took to answer one judgement of its pick (ms)
+#   cpu        - CPU time of the three characters together (ms)
+#   decode     - millions of barriers per second through the wizard's decoder
+#                (decode_caesar_cipher, via plugin_bisect.so in plugin_ab)
+#
+# Rooms mostly wait on signals, futexes and the other processes, so the first five columns
+# move little between builds; decode shows what the compiler does for the handlers' own code.
+#
+# Usage: ./bench.sh [games]     (default 20)
+
+games=${1:-20}
+src=$(cd "$(dirname "$0")" && pwd)
+work=$(mktemp -d) || exit 1
+trap 'rm -rf "$work"' EXIT
+
+printf '%-8s %10s %9s %9s %9s %9s %9s %9s\n' build rooms/s barb_ms wiz_ms unlock_ms pick_ms cpu_ms decode_M
+for build in default release lto pgo; do
+    dir="$work/$build"
+    mkdir -p "$dir"
+    cp "$src"/*.c "$src"/*.h "$src"/Makefile "$src"/dungeon.o "$dir"/
+    case $build in
+        default) target="all DUNGEON_OBJ=engine.o" ;;
+        *) target=$build ;;
+    esac
+    if ! (cd "$dir" && make $target TURBO_GAMES="$games" > build.log 2>&1); then
+        echo "$build: build failed, see below" >&2
+        tail -20 "$dir/build.log" >&2
+        continue
+    fi
+    decode=$(cd "$dir" && ./plugin_ab -S 1 -r 1000 ./plugin_bisect.so ./plugin_bisect.so |
+             awk '/^Decode throughput/ { print $4 / 1000000 }')
+    i=0
+    while [ "$i" -lt "$games" ]; do
+        (cd "$dir" && ./game) 2>&1
+        i=$((i + 1))
+    done | awk -v build="$build" -v decode="$decode" '
+        /^Played / { gsub(/[()]/, "", $7); rooms += $7; n++ }
+        /^Barbarian answered / { barb += $6; nb++ }
+        /^Wizard answered / { wiz += $6; nw++ }
+        /^Trap \(/ { for (i = 1; i <= NF; i++) if ($i == "mean") { unlock += $(i - 2); nu++ } }
+        /^Rogue tick:/ { gsub(/[()]/, ""); pick += $8; np++ }
+        / CPU time: / { cpu += ($4 + $7) * 1000 }
+        function mean(sum, count) { return count ? sum / count : 0 }
+        END {
+            printf "%-8s %10.1f %9.3f %9.3f %9.3f %9.3f %9.3f %9.2f\n", build, mean(rooms, n), mean(barb, nb),
+                   mean(wiz, nw), mean(unlock, nu), mean(pick, np), mean(cpu, n), decode
+        }'
+done
@@ -0,0 +1,354 @@
+/*
+ * character.c - Runtime shared by the Barbarian, Wizard and Rogue processes. See character.h.
+ */
+#define _XOPEN_SOURCE 700       // Ensure POSIX features are available
+#define _POSIX_C_SOURCE 200809L // Ensure POSIX.1-2008 compliance
+#define _DEFAULT_SOURCE         // For syscall (futex, see dungeon_futex.h)
+#define DUNGEON_LIBRARY         // The character program defines the resource names
+
+#include <stdio.h>        // For printf, perror
+#include <stdlib.h>       // For exit, getenv
+#include <string.h>       // For memset, strcmp
+#include <errno.h>        // For errno
+#include <fcntl.h>        // For O_* constants
+#include <poll.h>         // For poll
+#include <signal.h>       // For sigaction
+#include <stdint.h>       // For uint64_t
+#include <sys/mman.h>     // For shm_open, mmap, munmap
+#include <sys/stat.h>     // For stat
+#include <unistd.h>       // For read, close, getpid
+
+#include "character.h"
+#include "dungeon_settings.h"
+#include "dungeon_futex.h"
+#include "dungeon_signals.h"
+
+volatile sig_atomic_t exit_flag = 0;
+
+// The character this process runs, for the signal handlers.
+static struct Character *active = NULL;
+
+static const char *strategy_names[] = {"signal", "futex", "spin", "park", "eventfd"};
+
+// --- Signal Handlers ---
+
+/*
+ * stop_handler - Handles SIGINT by asking the main loop to finish.
+ */
+static void stop_handler(int signum) {
+    (void)signum;
+    exit_flag = 1;
+}
+
+/*
+ * room_handler - Handles DUNGEON_SIGNAL and SEMAPHORE_SIGNAL, which do not say which room
+ * they are about, so the current room is served.
+ */
+static void room_handler(int signum) {
+    if (active == NULL || active->dungeon == NULL) {
+        return;
+    }
+    active->serve(signum, __atomic_load_n(&active->dungeon->roomSeq, __ATOMIC_ACQUIRE));
+}
+
+/*
+ * payload_handler - Handles DUNGEON_RT_SIGNAL and SEMAPHORE_RT_SIGNAL.
+ * Serves exactly the room named in the payload, and drops the signal if that room has closed.
+ */
+static void payload_handler(int signum, siginfo_t *info, void *context) {
+    (void)context;
+    unsigned int room;
+    if (active == NULL || active->dungeon == NULL || !room_signal_current(info->si_value, active->dungeon, &room)) {
+        return;
+    }
+    active->serve(room_signal_classic(signum), room);
+}
+
+/*
+ * install - Registers a handler, exiting with a message if sigaction fails.
+ */
+static void install(struct Character *self, int signum, struct sigaction *action, const char *what) {
+    if (sigaction(signum, action, NULL) == -1) {
+        fprintf(stderr, "%s: sigaction failed for %s: %s\n", self->name, what, strerror(errno));
+        character_detach(self);
+        exit(EXIT_FAILURE);
+    }
+}
+
+// --- Waiting for Rooms ---
+
+/*
+ * cpu_relax - Tells the CPU we are spinning, so a sibling hyperthread gets the pipeline.
+ */
+static inline void cpu_relax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#else
+    __atomic_signal_fence(__ATOMIC_SEQ_CST);
+#endif
+}
+
+/*
+ * spin_for_room - Polls roomSeq until it moves past @seen or @budget_ns pass.
+ * Returns the latest roomSeq.
+ */
+static unsigned int spin_for_room(struct Character *self, unsigned int seen, long long budget_ns) {
+    long long until = clock_now() + budget_ns;
+    unsigned int seq = seen;
+    for (unsigned int i = 0; exit_flag == 0; i++) {
+        seq = __atomic_load_n(&self->dungeon->roomSeq, __ATOMIC_ACQUIRE);
+        if (seq != seen || ((i & 1023) == 0 && clock_now() >= until)) {
+            break;
+        }
+        cpu_relax();
+    }
+    return seq;
+}
+
+/*
+ * wait_for_room - Waits with the character's strategy until roomSeq moves past @seen, or at
+ * most CHARACTER_WAIT_TIMEOUT so the caller can notice the dungeon stopping.
+ * Returns the latest roomSeq (equal to @seen if nothing happened).
+ */
+static unsigned int wait_for_room(struct Character *self, unsigned int seen, int event_fd) {
+    struct Dungeon *dungeon = self->dungeon;
+    long long timeout = CHARACTER_WAIT_TIMEOUT * NSEC_PER_USEC;
+    switch (self->wait) {
+    case WAIT_SPIN:
+        return spin_for_room(self, seen, timeout);
+    case WAIT_PARK: {
+        unsigned int seq = spin_for_room(self, seen, CHARACTER_SPIN_TIME * NSEC_PER_USEC);
+        if (seq != seen) {
+            return seq;
+        }
+        futex_wait(&dungeon->roomSeq, seen, timeout);
+        break;
+    }
+    case WAIT_FUTEX:
+        futex_wait(&dungeon->roomSeq, seen, timeout);
+        break;
+    case WAIT_EVENTFD: {
+        struct pollfd ready = {event_fd, POLLIN, 0};
+        if (poll(&ready, 1, (int)(timeout / 1000000)) > 0) {
+            uint64_t count;
+            if (read(event_fd, &count, sizeof(count)) == -1 && errno != EAGAIN) {
+                perror("CHARACTER: read from eventfd failed");
+            }
+        }
+        break;
+    }
+    case WAIT_SIGNAL:
+        break;
+    }
+    return __atomic_load_n(&dungeon->roomSeq, __ATOMIC_ACQUIRE);
+}
+
+/*
+ * poll_rooms - Main loop for every strategy but signal.
+ * Wakes when roomSeq moves, then serves the room if it is this character's or the treasure.
+ */
+static void poll_rooms(struct Character *self) {
+    struct Dungeon *dungeon = self->dungeon;
+    int event_fd = dungeon->eventFds[self->role];
+    if (self->wait == WAIT_EVENTFD && event_fd <= 0) {
+        printf("[%s] No eventfd was set up by the dungeon master; waiting on roomSeq instead.\n", self->name);
+        self->wait = WAIT_FUTEX;
+    }
+    unsigned int seen = __atomic_load_n(&dungeon->roomSeq, __ATOMIC_ACQUIRE);
+    while (dungeon->running && exit_flag == 0) {
+        unsigned int seq = wait_for_room(self, seen, event_fd);
+        if (seq == seen) {
+            continue;
+        }
+        seen = seq;
+        int type = __atomic_load_n(&dungeon->roomType, __ATOMIC_ACQUIRE);
+        if (type == self->roomType) {
+            self->serve(DUNGEON_SIGNAL, seq);
+        } else if (type == ROOM_TREASURE) {
+            self->serve(SEMAPHORE_SIGNAL, seq);
+        }
+    }
+}
+
+// --- Public Interface ---
+
+/*
+ * character_attach - See character.h.
+ */
+void character_attach(struct Character *self) {
+    self->dungeon = NULL;
+    self->levers[0] = SEM_FAILED;
+    self->levers[1] = SEM_FAILED;
+    memset(&self->strategy, 0, sizeof(self->strategy));
+    active = self;
+
+    self->wait = CHARACTER_WAIT_STRATEGY;
+    const char *requested = getenv("DUNGEON_WAIT");
+    if (requested != NULL) {
+        for (int i = 0; i < (int)(sizeof(strategy_names) / sizeof(strategy_names[0])); i++) {
+            if (strcmp(requested, strategy_names[i]) == 0) {
+                self->wait = (enum WaitStrategy)i;
+            }
+        }
+    }
+
+    int fd = shm_open(dungeon_shm_name, O_RDWR, 0666);
+    if (fd == -1) {
+        fprintf(stderr, "%s: shm_open failed: %s\n", self->name, strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+    struct Dungeon *dungeon = mmap(NULL, sizeof(struct Dungeon), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (dungeon == MAP_FAILED) {
+        fprintf(stderr, "%s: mmap failed: %s\n", self->name, strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+    self->dungeon = dungeon;
+    printf("[%s] Connected to shared memory.\n", self->name);
+
+    self->levers[0] = sem_open(dungeon_lever_one, O_RDWR);
+    self->levers[1] = sem_open(dungeon_lever_two, O_RDWR);
+    if (self->levers[0] == SEM_FAILED || self->levers[1] == SEM_FAILED) {
+        fprintf(stderr, "%s: sem_open failed for lever %s: %s\n", self->name,
+                self->levers[0] == SEM_FAILED ? "one" : "two", strerror(errno));
+        character_detach(self);
+        exit(EXIT_FAILURE);
+    }
+    printf("[%s] Connected to semaphores. Waiting for rooms with the %s strategy.\n", self->name,
+           strategy_names[self->wait]);
+
+    // A plugin that fails to load leaves the built-in logic in charge.
+    const char *plugin = getenv("DUNGEON_PLUGIN");
+    if (plugin == NULL) {
+        plugin = CHARACTER_PLUGIN;
+    }
+    if (plugin != NULL && plugin[0] != '\0') {
+        if (plugin_load(&self->strategy, plugin) == 0) {
+            printf("[%s] Loaded the %s plugin from %s.\n", self->name, self->strategy.plugin->name, plugin);
+        } else {
+            printf("[%s] Using the built-in logic instead of %s.\n", self->name, plugin);
+        }
+    }
+}
+
+/*
+ * character_run - See character.h.
+ */
+void character_run(struct Character *self) {
+    struct sigaction action;
+
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = stop_handler;
+    install(self, SIGINT, &action, "SIGINT");
+
+    if (self->wait != WAIT_SIGNAL) {
+        // Rooms are found through roomSeq; the engine's signals carry nothing new.
+        memset(&action, 0, sizeof(action));
+        action.sa_handler = SIG_IGN;
+        install(self, DUNGEON_SIGNAL, &action, "DUNGEON_SIGNAL");
+        install(self, SEMAPHORE_SIGNAL, &action, "SEMAPHORE_SIGNAL");
+        install(self, DUNGEON_RT_SIGNAL, &action, "DUNGEON_RT_SIGNAL");
+        install(self, SEMAPHORE_RT_SIGNAL, &action, "SEMAPHORE_RT_SIGNAL");
+        printf("[%s] Ready for rooms...\n", self->name);
+        poll_rooms(self);
+        return;
+    }
+
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = room_handler;
+    install(self, DUNGEON_SIGNAL, &action, "DUNGEON_SIGNAL");
+    install(self, SEMAPHORE_SIGNAL, &action, "SEMAPHORE_SIGNAL");
+    memset(&action, 0, sizeof(action));
+    action.sa_sigaction = payload_handler;
+    action.sa_flags = SA_SIGINFO;
+    install(self, DUNGEON_RT_SIGNAL, &action, "DUNGEON_RT_SIGNAL");
+    install(self, SEMAPHORE_RT_SIGNAL, &action, "SEMAPHORE_RT_SIGNAL");
+    printf("[%s] Ready to receive signals...\n", self->name);
+
+    if (CHARACTER_SIGNALFD) {
+        // Block the room signals and serve them from a signalfd, outside any handler.
+        int signal_fd = room_signal_fd();
+        if (signal_fd == -1) {
+            fprintf(stderr, "%s: signalfd failed: %s\n", self->name, strerror(errno));
+            return;
+        }
+        char label[32];
+        snprintf(label, sizeof(label), "[%s]", self->name);
+        if (room_signal_loop(signal_fd, self->dungeon, &exit_flag, self->serve, label) == -1) {
+            fprintf(stderr, "%s: read from signalfd failed: %s\n", self->name, strerror(errno));
+        }
+        close(signal_fd);
+        return;
+    }
+
+    // Block everything but the signals we handle, and sleep until one arrives.
+    sigset_t mask;
+    sigfillset(&mask);
+    sigdelset(&mask, DUNGEON_SIGNAL);
+    sigdelset(&mask, SEMAPHORE_SIGNAL);
+    sigdelset(&mask, DUNGEON_RT_SIGNAL);
+    sigdelset(&mask, SEMAPHORE_RT_SIGNAL);
+    sigdelset(&mask, SIGINT);
+    while (self->dungeon->running && exit_flag == 0) {
+        sigsuspend(&mask);
+    }
+}
+
+/*
+ * character_hold - See character.h.
+ */
+void character_hold(struct Character *self, const struct Deadline *deadline) {
+    struct Dungeon *dungeon = self->dungeon;
+    while (dungeon->running && dungeon->spoils[3] == '\0' && exit_flag == 0 && !deadline_passed(deadline)) {
+        if (self->wait == WAIT_SPIN) {
+            cpu_relax();
+        } else {
+            clock_sleep(CHARACTER_HOLD_POLL * NSEC_PER_USEC);
+        }
+    }
+}
+
+/*
+ * character_strategy - See character.h.
+ */
+const struct CharacterPlugin *character_strategy(struct Character *self) {
+    struct PluginHandle *handle = &self->strategy;
+    if (handle->path != NULL && plugin_changed(handle)) {
+        const char *path = handle->path;
+        if (plugin_load(handle, path) == 0) {
+            printf("[%s] Reloaded the %s plugin from %s.\n", self->name, handle->plugin->name, path);
+        } else {
+            printf("[%s] Reloading %s failed; using the built-in logic.\n", self->name, path);
+            // Remember this version, so a broken file is not retried on every room.
+            struct stat info;
+            if (stat(path, &info) == 0) {
+                handle->modified = info.st_mtim;
+                handle->inode = info.st_ino;
+            }
+        }
+    }
+    return handle->plugin;
+}
+
+/*
+ * character_detach - See character.h.
+ */
+void character_detach(struct Character *self) {
+    char label[32];
+    snprintf(label, sizeof(label), "[%s]", self->name);
+    clock_report_cpu(label);
+    plugin_unload(&self->strategy);
+    if (self->dungeon != NULL) {
+        if (munmap(self->dungeon, sizeof(struct Dungeon)) == -1) {
+            fprintf(stderr, "%s: munmap failed: %s\n", self->name, strerror(errno));
+        }
+        self->dungeon = NULL;
+    }
+    for (int i = 0; i < 2; i++) {
+        if (self->levers[i] != SEM_FAILED && sem_close(self->levers[i]) == -1) {
+            fprintf(stderr, "%s: sem_close lever%d failed: %s\n", self->name, i + 1, strerror(errno));
+        }
+        self->levers[i] = SEM_FAILED;
+    }
+    active = NULL;
+}
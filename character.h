@@ -0,0 +1,86 @@
+/*
+ * character.h - Runtime shared by the Barbarian, Wizard and Rogue processes.
+ * One attach path (shared memory and levers), one detach path, and one main loop that waits
+ * for rooms with a configurable strategy and hands each room to the character's serve
+ * function:
+ *
+ *   signal  - DUNGEON_SIGNAL/SEMAPHORE_SIGNAL (or their realtime versions), read from a
+ *             signalfd or handled in a signal handler (CHARACTER_SIGNALFD). Works with dungeon.o.
+ *   futex   - Sleeps on Dungeon.roomSeq, which engine.c wakes whenever a room opens.
+ *   spin    - Polls Dungeon.roomSeq without sleeping. Lowest latency, burns a core.
+ *   park    - Spins for CHARACTER_SPIN_TIME, then sleeps on roomSeq like futex.
+ *   eventfd - Blocks on the character's eventfd from Dungeon.eventFds, which game.c creates and
+ *             engine.c writes whenever it signals the character.
+ *
+ * How the Wizard decodes barriers and how the Rogue searches traps can also come from a
+ * shared object (character_plugin.h), named by CHARACTER_PLUGIN or DUNGEON_PLUGIN.
+ *
+ * Every strategy but signal relies on engine.c publishing Dungeon.roomSeq and roomType, so it
+ * needs `make DUNGEON_OBJ=engine.o`. The strategy comes from CHARACTER_WAIT_STRATEGY, or from
+ * the DUNGEON_WAIT environment variable (signal, futex, spin, park or eventfd) when it is set.
+ */
+#ifndef DUNGEON_CHARACTER_H
+#define DUNGEON_CHARACTER_H
+
+#include <semaphore.h>  // For sem_t
+#include <signal.h>     // For sig_atomic_t
+
+#include "dungeon_info.h"
+#include "dungeon_clock.h"
+#include "character_plugin.h"
+
+enum WaitStrategy {
+    WAIT_SIGNAL,
+    WAIT_FUTEX,
+    WAIT_SPIN,
+    WAIT_PARK,
+    WAIT_EVENTFD
+};
+
+struct Character {
+    const char *name;          // "BARBARIAN", "WIZARD" or "ROGUE", used in messages
+    enum CharacterRole role;
+    int roomType;              // enum RoomType this character answers on DUNGEON_SIGNAL
+    // Serves one room: DUNGEON_SIGNAL for the character's own rooms, SEMAPHORE_SIGNAL for the treasure.
+    void (*serve)(int signum, unsigned int room);
+
+    enum WaitStrategy wait;    // Set by character_attach
+    struct Dungeon *dungeon;   // Mapped by character_attach
+    sem_t *levers[2];          // Lever One and Lever Two, opened by character_attach
+    struct PluginHandle strategy; // Plugin from CHARACTER_PLUGIN or DUNGEON_PLUGIN, if any
+};
+
+// Set once the character has been told to stop (SIGINT).
+extern volatile sig_atomic_t exit_flag;
+
+/*
+ * character_attach - Maps the dungeon, opens both levers and picks the wait strategy.
+ * Prints the reason and exits the process if any of it fails.
+ * @self: The character, with name, role, roomType and serve filled in.
+ */
+void character_attach(struct Character *self);
+
+/*
+ * character_run - Serves rooms until the dungeon stops running or the character is stopped.
+ */
+void character_run(struct Character *self);
+
+/*
+ * character_hold - Waits while holding a lever, until the Rogue has collected the spoils,
+ * the dungeon stops, the character is stopped or @deadline passes.
+ */
+void character_hold(struct Character *self, const struct Deadline *deadline);
+
+/*
+ * character_strategy - Returns the character's plugin, or NULL to use the built-in logic.
+ * Reloads the plugin first if its file changed since it was loaded, so call it once when a
+ * room opens and keep the result for that room.
+ */
+const struct CharacterPlugin *character_strategy(struct Character *self);
+
+/*
+ * character_detach - Reports CPU time, unloads the plugin, unmaps the dungeon and closes the levers.
+ */
+void character_detach(struct Character *self);
+
+#endif
@@ -0,0 +1,142 @@
+/*
+ * character_plugin.h - C ABI for character strategies loaded from shared objects.
+ * A strategy is a shared object that defines one `const struct CharacterPlugin character_plugin`.
+ * The character runtime loads it with dlopen when CHARACTER_PLUGIN or the DUNGEON_PLUGIN
+ * environment variable names it, and reloads it when the file changes, so a rebuilt strategy
+ * takes over from the next room without respawning the characters. plugin_ab loads two of
+ * them and plays both against the same seeded traps and barriers.
+ *
+ * The Wizard asks the plugin to decode barriers and the Rogue asks it where to pick; every
+ * character tells it when the treasure room is over. Monsters and the treasure levers always
+ * use the built-in logic. A plugin that leaves a hook
+ * NULL (or returns -1 from on_room) gets the built-in behaviour for it.
+ *
+ * Trap protocol, as the Rogue and plugin_ab drive it:
+ *   on_trap_feedback(state, 0, 'w')      once after init: returns the first pick to park
+ *   on_room(state, ROOM_TRAP, ...)        a trap locked: start a new search
+ *   on_trap_feedback(state, pick, 'u')    @pick was too low: return the next pick
+ *   on_trap_feedback(state, pick, 'd')    @pick was too high: return the next pick
+ *   on_trap_feedback(state, pick, '-')    @pick unlocked the trap: return where to park for the next one
+ * A negative pick gives up: the Rogue finishes the trap with its built-in search, and
+ * plugin_ab counts the trap as failed.
+ */
+#ifndef DUNGEON_CHARACTER_PLUGIN_H
+#define DUNGEON_CHARACTER_PLUGIN_H
+
+#include <dlfcn.h>      // For dlopen, dlsym, dlclose, dlerror
+#include <stdbool.h>    // For bool type
+#include <stdio.h>      // For fprintf
+#include <string.h>     // For memset
+#include <sys/stat.h>   // For stat
+
+// Bumped whenever struct CharacterPlugin or the meaning of a hook changes.
+#define CHARACTER_PLUGIN_ABI (1)
+
+// Name of the symbol a plugin defines.
+#define CHARACTER_PLUGIN_SYMBOL "character_plugin"
+
+struct CharacterPlugin {
+    unsigned int abi;          // CHARACTER_PLUGIN_ABI the plugin was built against
+    const char *name;          // Shown in messages and plugin_ab reports
+
+    // Sets up the plugin's state. Returns 0 on success, -1 to refuse loading.
+    int (*init)(void **state);
+
+    // A room of the character's kind opened. For ROOM_BARRIER, decodes @input (key first) into
+    // @output of @size bytes and returns its length. For ROOM_TRAP, @input and @output are NULL
+    // and a new search starts; returns 0. Returns -1 to let the built-in logic serve the room.
+    int (*on_room)(void *state, int type, const char *input, char *output, int size);
+
+    // Feedback on the current pick (see the trap protocol above). Returns the next pick.
+    float (*on_trap_feedback)(void *state, float pick, char direction);
+
+    // The treasure room is over; @spoils is what the Rogue collected (may be short).
+    void (*on_treasure)(void *state, const char *spoils);
+
+    // Frees the plugin's state before it is unloaded.
+    void (*fini)(void *state);
+};
+
+// A loaded plugin and where it came from.
+struct PluginHandle {
+    void *library;                          // From dlopen, NULL when nothing is loaded
+    const struct CharacterPlugin *plugin;
+    void *state;                            // From the plugin's init
+    const char *path;
+    struct timespec modified;               // st_mtim of the file when it was loaded
+    ino_t inode;                            // st_ino of the file when it was loaded
+};
+
+/*
+ * plugin_unload - Finalizes and unloads a plugin. Does nothing if none is loaded.
+ */
+static inline void plugin_unload(struct PluginHandle *handle) {
+    if (handle->library == NULL) {
+        return;
+    }
+    if (handle->plugin->fini != NULL) {
+        handle->plugin->fini(handle->state);
+    }
+    dlclose(handle->library);
+    handle->library = NULL;
+    handle->plugin = NULL;
+    handle->state = NULL;
+}
+
+/*
+ * plugin_load - Loads the plugin at @path and runs its init.
+ * Unloads whatever @handle held first. A path without a slash is looked up the way dlopen
+ * does, so pass "./name.so" for a file in the current directory.
+ * Returns 0 on success, or -1 after printing why the plugin could not be used.
+ */
+static inline int plugin_load(struct PluginHandle *handle, const char *path) {
+    plugin_unload(handle);
+    handle->path = path;
+    struct stat info;
+    if (stat(path, &info) == -1) {
+        memset(&info, 0, sizeof(info));
+    }
+    void *library = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+    if (library == NULL) {
+        fprintf(stderr, "PLUGIN: dlopen failed: %s\n", dlerror());
+        return -1;
+    }
+    const struct CharacterPlugin *plugin = dlsym(library, CHARACTER_PLUGIN_SYMBOL);
+    if (plugin == NULL) {
+        fprintf(stderr, "PLUGIN: %s does not define %s\n", path, CHARACTER_PLUGIN_SYMBOL);
+        dlclose(library);
+        return -1;
+    }
+    if (plugin->abi != CHARACTER_PLUGIN_ABI) {
+        fprintf(stderr, "PLUGIN: %s was built for ABI %u, expected %u\n", path, plugin->abi, CHARACTER_PLUGIN_ABI);
+        dlclose(library);
+        return -1;
+    }
+    void *state = NULL;
+    if (plugin->init != NULL && plugin->init(&state) != 0) {
+        fprintf(stderr, "PLUGIN: %s refused to initialize\n", plugin->name);
+        dlclose(library);
+        return -1;
+    }
+    handle->library = library;
+    handle->plugin = plugin;
+    handle->state = state;
+    handle->modified = info.st_mtim;
+    handle->inode = info.st_ino;
+    return 0;
+}
+
+/*
+ * plugin_changed - Returns true if the file at handle->path was replaced or modified since it
+ * was loaded. A missing file counts as unchanged, so deleting it mid-build keeps the old code.
+ */
+static inline bool plugin_changed(const struct PluginHandle *handle) {
+    struct stat info;
+    if (handle->path == NULL || stat(handle->path, &info) == -1) {
+        return false;
+    }
+    return info.st_ino != handle->inode || info.st_mtim.tv_sec != handle->modified.tv_sec ||
+           info.st_mtim.tv_nsec != handle->modified.tv_nsec;
+}
+
+#endif
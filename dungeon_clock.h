@@ -0,0 +1,105 @@
+/*
+ * dungeon_clock.h - Monotonic deadline helpers shared by the characters.
+ * All times are nanoseconds on CLOCK_MONOTONIC, which is read through the vDSO without
+ * a system call. Polling loops check deadlines against CLOCK_MONOTONIC_COARSE, which is
+ * cheaper still and lags the precise clock by at most one scheduler tick.
+ */
+#ifndef DUNGEON_CLOCK_H
+#define DUNGEON_CLOCK_H
+
+#include <stdbool.h>    // For bool type
+#include <stdio.h>      // For printf
+#include <sys/resource.h> // For getrusage
+#include <time.h>       // For clock_gettime, CLOCK_MONOTONIC, CLOCK_MONOTONIC_COARSE
+
+#include "dungeon_info.h"
+
+#define NSEC_PER_USEC (1000LL)
+#define NSEC_PER_SEC (1000000000LL)
+
+// How far past a character's own budget a published room deadline may lie before it is ignored.
+#define DEADLINE_TRUST_SLACK (NSEC_PER_SEC)
+
+// An absolute point in time, in nanoseconds on CLOCK_MONOTONIC.
+struct Deadline {
+    long long at;
+};
+
+/*
+ * clock_now - Returns the current CLOCK_MONOTONIC time in nanoseconds.
+ */
+static inline long long clock_now(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long long)now.tv_sec * NSEC_PER_SEC + now.tv_nsec;
+}
+
+/*
+ * clock_now_coarse - Returns the CLOCK_MONOTONIC_COARSE time in nanoseconds.
+ * Same time base as clock_now, but only updated once per scheduler tick.
+ */
+static inline long long clock_now_coarse(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &now);
+    return (long long)now.tv_sec * NSEC_PER_SEC + now.tv_nsec;
+}
+
+/*
+ * clock_sleep - Sleeps for the given number of nanoseconds.
+ * A drop-in for usleep, which POSIX.1-2008 no longer declares.
+ */
+static inline void clock_sleep(long long ns) {
+    struct timespec interval;
+    interval.tv_sec = ns / NSEC_PER_SEC;
+    interval.tv_nsec = ns % NSEC_PER_SEC;
+    nanosleep(&interval, NULL);
+}
+
+/*
+ * deadline_from - Sets a deadline from one an engine published, or from @budget_ns.
+ * Uses @published when it is still in the future, and otherwise measures the budget from now,
+ * which is the best a character can do when the engine (e.g. dungeon.o) does not publish
+ * deadlines. A published deadline further out than the budget plus DEADLINE_TRUST_SLACK is
+ * not trusted either, so a corrupt segment cannot keep a character busy for hours.
+ * @deadline: The deadline to set.
+ * @published: Absolute deadline from the engine, 0 if none.
+ * @budget_ns: Fallback budget in nanoseconds.
+ */
+static inline void deadline_from(struct Deadline *deadline, long long published, long long budget_ns) {
+    long long now = clock_now();
+    bool trusted = published > now && published - now <= budget_ns + DEADLINE_TRUST_SLACK;
+    deadline->at = trusted ? published : now + budget_ns;
+}
+
+/*
+ * deadline_for_room - Sets the deadline for the room that is currently open, from
+ * dungeon->roomDeadline (see deadline_from).
+ * @deadline: The deadline to set.
+ * @dungeon: Pointer to the shared Dungeon struct.
+ * @budget_ns: Fallback budget in nanoseconds.
+ */
+static inline void deadline_for_room(struct Deadline *deadline, const struct Dungeon *dungeon, long long budget_ns) {
+    deadline_from(deadline, __atomic_load_n(&dungeon->roomDeadline, __ATOMIC_ACQUIRE), budget_ns);
+}
+
+/*
+ * deadline_passed - Returns true once the deadline has been reached.
+ * Cheap enough to call on every iteration of a polling loop.
+ */
+static inline bool deadline_passed(const struct Deadline *deadline) {
+    return clock_now_coarse() >= deadline->at;
+}
+
+/*
+ * clock_report_cpu - Prints the CPU time this process has used so far.
+ * @label: Prefix for the line, e.g. "[BARBARIAN]".
+ */
+static inline void clock_report_cpu(const char *label) {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        printf("%s CPU time: %ld.%06ld s user, %ld.%06ld s system.\n", label, (long)usage.ru_utime.tv_sec,
+               (long)usage.ru_utime.tv_usec, (long)usage.ru_stime.tv_sec, (long)usage.ru_stime.tv_usec);
+    }
+}
+
+#endif
@@ -0,0 +1,128 @@
+/*
+ * dungeon_corpus.h - Barrier phrases drawn from a large text file.
+ * The built-in incantations are ten short phrases, which never stress the Wizard's decoding.
+ * With a spell corpus set (SPELL_CORPUS, or the DUNGEON_CORPUS environment variable), engine.o
+ * and master draw every barrier's phrase from that file instead: any text will do, one phrase
+ * per line, e.g. a book or a log.
+ *
+ * The file is mapped read-only and shared, once per process, and is never copied: every
+ * engine, load generator and master on the host reads the same page cache, and the master's
+ * games all share its one mapping. Drawing a phrase touches only the pages it lies on.
+ *
+ * A draw picks a random byte of the file and takes the line that starts after it, so there is
+ * no index to build, however large the file. Lines that follow long lines are drawn more often.
+ * The phrase is the line clipped to SPELL_BUFFER_SIZE - 1 characters, the most a Wizard can
+ * answer, with control characters turned into spaces. Its position is the byte offset of the
+ * line, which identifies it in the results log.
+ */
+#ifndef DUNGEON_CORPUS_H
+#define DUNGEON_CORPUS_H
+
+#include <stdint.h>     // For uint64_t
+#include <stdio.h>      // For fprintf, perror
+#include <stdlib.h>     // For getenv
+#include <string.h>     // For memchr
+#include <fcntl.h>      // For open
+#include <sys/mman.h>   // For mmap, posix_madvise, munmap
+#include <sys/stat.h>   // For fstat
+#include <unistd.h>     // For close
+
+#include "dungeon_settings.h"  // For SPELL_CORPUS, SPELL_BUFFER_SIZE
+
+// A mapped spell corpus. text is NULL when none is open.
+struct SpellCorpus {
+    const char *text;
+    size_t size;
+};
+
+/*
+ * corpus_path - Returns the spell corpus to draw barriers from, or NULL to use the built-in phrases.
+ * The DUNGEON_CORPUS environment variable overrides SPELL_CORPUS; an empty value turns it off.
+ */
+static inline const char *corpus_path(void) {
+    const char *path = getenv("DUNGEON_CORPUS");
+    if (path == NULL) {
+        path = SPELL_CORPUS;
+    }
+    return (path != NULL && path[0] != '\0') ? path : NULL;
+}
+
+/*
+ * corpus_open - Maps the spell corpus at @path read-only.
+ * Returns 0 on success, -1 (with a message) otherwise.
+ */
+static inline int corpus_open(struct SpellCorpus *corpus, const char *path) {
+    corpus->text = NULL;
+    corpus->size = 0;
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) {
+        perror("CORPUS: open failed");
+        return -1;
+    }
+    struct stat info;
+    if (fstat(fd, &info) == -1 || info.st_size == 0) {
+        fprintf(stderr, "CORPUS: %s is empty.\n", path);
+        close(fd);
+        return -1;
+    }
+    void *memory = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd); // The mapping stays valid after the descriptor is closed.
+    if (memory == MAP_FAILED) {
+        perror("CORPUS: mmap failed");
+        return -1;
+    }
+    posix_madvise(memory, (size_t)info.st_size, POSIX_MADV_RANDOM); // Draws jump around; readahead would be wasted.
+    corpus->text = (const char *)memory;
+    corpus->size = (size_t)info.st_size;
+    return 0;
+}
+
+/*
+ * corpus_close - Unmaps a spell corpus.
+ */
+static inline void corpus_close(struct SpellCorpus *corpus) {
+    if (corpus->text != NULL) {
+        munmap((void *)corpus->text, corpus->size);
+    }
+    corpus->text = NULL;
+    corpus->size = 0;
+}
+
+/*
+ * corpus_draw - Copies a random phrase out of the corpus.
+ * @random: Random bits that choose the phrase.
+ * @phrase: Receives the phrase, null-terminated (SPELL_BUFFER_SIZE bytes).
+ * Returns the byte offset of the phrase's line, or -1 if the corpus has no text but blank lines.
+ */
+static inline long long corpus_draw(const struct SpellCorpus *corpus, uint64_t random, char *phrase) {
+    const char *text = corpus->text;
+    size_t size = corpus->size;
+    size_t start = random % size;
+    if (start > 0 && text[start - 1] != '\n') {
+        const char *newline = memchr(text + start, '\n', size - start);
+        start = newline != NULL ? (size_t)(newline - text) + 1 : size;
+    }
+    // Skip blank lines, going round to the start of the file at most once.
+    for (size_t scanned = 0; scanned <= size; scanned++, start++) {
+        if (start >= size) {
+            start = 0;
+        }
+        if (text[start] == '\n' || text[start] == '\r') {
+            continue;
+        }
+        size_t length = 0;
+        while (start + length < size && length < SPELL_BUFFER_SIZE - 1 && text[start + length] != '\n') {
+            unsigned char c = (unsigned char)text[start + length];
+            phrase[length++] = c < ' ' ? ' ' : (char)c;
+        }
+        if (length > 0 && text[start + length - 1] == '\r') {
+            length--; // CRLF line ending
+        }
+        phrase[length] = '\0';
+        return (long long)start;
+    }
+    phrase[0] = '\0';
+    return -1;
+}
+
+#endif
@@ -0,0 +1,43 @@
+/*
+ * dungeon_futex.h - Futex wait and wake on words inside the shared Dungeon.
+ * The words live in MAP_SHARED memory used by several processes, so the process-shared
+ * (non-PRIVATE) futex operations are used. A waiter sleeps in the kernel until a writer
+ * changes the word and calls futex_wake, with no polling interval in between.
+ */
+#ifndef DUNGEON_FUTEX_H
+#define DUNGEON_FUTEX_H
+
+#include <errno.h>        // For errno, EAGAIN, ETIMEDOUT, EINTR
+#include <linux/futex.h>  // For FUTEX_WAIT, FUTEX_WAKE
+#include <limits.h>       // For INT_MAX
+#include <sys/syscall.h>  // For SYS_futex
+#include <time.h>         // For struct timespec
+#include <unistd.h>       // For syscall (needs _DEFAULT_SOURCE)
+
+/*
+ * futex_wait - Sleeps while *word still equals expected, for at most timeout_ns.
+ * @word: The shared word to wait on.
+ * @expected: The value the caller last saw.
+ * @timeout_ns: Longest time to sleep; negative means no limit.
+ * Returns 0 when woken, or -1 with errno EAGAIN (word already changed), ETIMEDOUT or EINTR.
+ */
+static inline int futex_wait(unsigned int *word, unsigned int expected, long long timeout_ns) {
+    struct timespec timeout;
+    struct timespec *limit = NULL;
+    if (timeout_ns >= 0) {
+        timeout.tv_sec = timeout_ns / 1000000000LL;
+        timeout.tv_nsec = timeout_ns % 1000000000LL;
+        limit = &timeout;
+    }
+    return (int)syscall(SYS_futex, word, FUTEX_WAIT, expected, limit, NULL, 0);
+}
+
+/*
+ * futex_wake - Wakes every process waiting on a shared word.
+ * Call it after changing the word.
+ */
+static inline void futex_wake(unsigned int *word) {
+    syscall(SYS_futex, word, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+#endif
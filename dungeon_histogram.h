@@ -0,0 +1,124 @@
+/*
+ * dungeon_histogram.h - Fixed-size latency histogram with log-linear buckets.
+ * Values below 16 ns get their own bucket; above that every power of two is split into
+ * eight buckets, so any reported percentile is within 12.5% of the true value. The struct
+ * has no pointers and a fixed size, so it can live in shared memory and be merged by adding.
+ */
+#ifndef DUNGEON_HISTOGRAM_H
+#define DUNGEON_HISTOGRAM_H
+
+#include <stdio.h>      // For printf
+
+#define HISTOGRAM_SUB_BUCKETS (8)
+#define HISTOGRAM_BUCKETS (16 + 44 * HISTOGRAM_SUB_BUCKETS) // Covers up to 2^48 ns (about 3 days)
+
+struct LatencyHistogram {
+    unsigned long counts[HISTOGRAM_BUCKETS];
+    unsigned long total;
+    long long sum;
+    long long max;
+};
+
+/*
+ * histogram_bucket - Returns the bucket index for a latency in nanoseconds.
+ */
+static inline int histogram_bucket(long long ns) {
+    if (ns < 16) {
+        return ns < 0 ? 0 : (int)ns;
+    }
+    int msb = 63 - __builtin_clzll((unsigned long long)ns);
+    int sub = (int)((ns >> (msb - 3)) & (HISTOGRAM_SUB_BUCKETS - 1));
+    int index = 16 + (msb - 4) * HISTOGRAM_SUB_BUCKETS + sub;
+    return index < HISTOGRAM_BUCKETS ? index : HISTOGRAM_BUCKETS - 1;
+}
+
+/*
+ * histogram_bucket_limit - Returns the largest latency that falls in a bucket.
+ */
+static inline long long histogram_bucket_limit(int index) {
+    if (index < 16) {
+        return index;
+    }
+    int msb = (index - 16) / HISTOGRAM_SUB_BUCKETS + 4;
+    int sub = (index - 16) % HISTOGRAM_SUB_BUCKETS;
+    return ((long long)(HISTOGRAM_SUB_BUCKETS + sub + 1) << (msb - 3)) - 1;
+}
+
+/*
+ * histogram_record - Adds one latency sample.
+ */
+static inline void histogram_record(struct LatencyHistogram *histogram, long long ns) {
+    histogram->counts[histogram_bucket(ns)]++;
+    histogram->total++;
+    histogram->sum += ns;
+    if (ns > histogram->max) {
+        histogram->max = ns;
+    }
+}
+
+/*
+ * histogram_record_shared - Adds one latency sample to a histogram other threads or processes
+ * update and read at the same time. Uses only relaxed atomics, so readers see each field
+ * up to date on its own but not necessarily consistent with the others.
+ */
+static inline void histogram_record_shared(struct LatencyHistogram *histogram, long long ns) {
+    __atomic_fetch_add(&histogram->counts[histogram_bucket(ns)], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&histogram->total, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&histogram->sum, ns, __ATOMIC_RELAXED);
+    long long max = __atomic_load_n(&histogram->max, __ATOMIC_RELAXED);
+    while (ns > max && !__atomic_compare_exchange_n(&histogram->max, &max, ns, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        // A failed exchange reloaded max; try again while ns is still the larger.
+    }
+}
+
+/*
+ * histogram_merge - Adds every sample of src into dst.
+ */
+static inline void histogram_merge(struct LatencyHistogram *dst, const struct LatencyHistogram *src) {
+    for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        dst->counts[i] += src->counts[i];
+    }
+    dst->total += src->total;
+    dst->sum += src->sum;
+    if (src->max > dst->max) {
+        dst->max = src->max;
+    }
+}
+
+/*
+ * histogram_percentile - Returns an upper bound on the given percentile (0-100), in ns.
+ */
+static inline long long histogram_percentile(const struct LatencyHistogram *histogram, double percentile) {
+    if (histogram->total == 0) {
+        return 0;
+    }
+    unsigned long rank = (unsigned long)(percentile / 100.0 * histogram->total);
+    if (rank >= histogram->total) {
+        rank = histogram->total - 1;
+    }
+    unsigned long seen = 0;
+    for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        seen += histogram->counts[i];
+        if (seen > rank) {
+            long long limit = histogram_bucket_limit(i);
+            return limit < histogram->max ? limit : histogram->max;
+        }
+    }
+    return histogram->max;
+}
+
+/*
+ * histogram_print - Prints the sample count and the usual percentiles in microseconds.
+ * @label: Printed at the start of the line, e.g. "[HOST] Room latency".
+ */
+static inline void histogram_print(const char *label, const struct LatencyHistogram *histogram) {
+    printf("%s: n=%lu p50=%.1fus p90=%.1fus p99=%.1fus p99.9=%.1fus max=%.1fus\n",
+           label, histogram->total,
+           histogram_percentile(histogram, 50.0) / 1000.0,
+           histogram_percentile(histogram, 90.0) / 1000.0,
+           histogram_percentile(histogram, 99.0) / 1000.0,
+           histogram_percentile(histogram, 99.9) / 1000.0,
+           histogram->max / 1000.0);
+}
+
+#endif
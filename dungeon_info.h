@@ -4,12 +4,20 @@
 #include <unistd.h>
 #include "dungeon_settings.h"
 
+#ifndef DUNGEON_LIBRARY
 //This is the name we will use for our shared memory.
 const char* dungeon_shm_name = "/DungeonMem";
 
 //These are the names for the levers when getting the treasure at the end.
 const char* dungeon_lever_one = "/LeverOne";
 const char* dungeon_lever_two = "/LeverTwo";
+#else
+//Object files linked into a program that includes this header (e.g. engine.o) define DUNGEON_LIBRARY
+//and use the program's copies of the names.
+extern const char* dungeon_shm_name;
+extern const char* dungeon_lever_one;
+extern const char* dungeon_lever_two;
+#endif
 
 
 struct Barbarian{
@@ -31,6 +39,18 @@ struct Trap{
 	char direction;
 	bool locked;
 };
+//The characters, in the order of Dungeon.eventFds. Every per-character array (engine.c's wins and runs,
+//the host counters in dungeon_slots.h) is indexed the same way.
+enum CharacterRole{
+	ROLE_WIZARD,
+	ROLE_BARBARIAN,
+	ROLE_ROGUE,
+	ROLE_COUNT
+};
+//Records which character process is currently holding a lever. 0 means nobody holds it.
+struct Lever{
+	pid_t owner;
+};
 struct Dungeon{
 	bool running;
 	pid_t dungeonPID;
@@ -42,6 +62,24 @@ struct Dungeon{
 	struct Trap trap;
 	char treasure[4];
 	char spoils[4];
+	//Fields below are appended after the layout that dungeon.o maps, so the library never reads them.
+	struct Lever levers[2];
+	//Length of the decoded string in wizard.spell, published after the spell is written.
+	int spellLength;
+	//Absolute CLOCK_MONOTONIC time (nanoseconds) at which the current room closes. 0 if the engine does not publish it.
+	long long roomDeadline;
+	//Incremented by the engine (engine.c) right before it signals a character about a new room.
+	unsigned int roomSeq;
+	//Set to roomSeq by a character once its answer for that room is written, so the engine can end the room early.
+	unsigned int answerSeq;
+	//Incremented by the rogue after every new pick it publishes, and once it parks its pick after an unlock. engine.c sleeps on it with a futex to judge each pick at once.
+	unsigned int pickSeq;
+	//CLOCK_MONOTONIC time (nanoseconds) at which the rogue published its current pick, used by engine.c to size its tick.
+	long long pickTime;
+	//enum RoomType (dungeon_slots.h) of the room roomSeq announced, published by engine.c before it bumps roomSeq.
+	int roomType;
+	//eventfd of each character, indexed by enum CharacterRole, created by game.c and written by engine.c when it signals them. 0 if not set up.
+	int eventFds[ROLE_COUNT];
 };
 
 //Call this method to begin running the dungeon. Valid pid's must be passed for it to work.
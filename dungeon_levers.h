@@ -0,0 +1,134 @@
+/*
+ * dungeon_levers.h - Lever ownership helpers shared by the characters and the Dungeon Master.
+ * A character records its PID in dungeon->levers[] right after it takes a lever semaphore
+ * and clears it right before posting. The Dungeon Master watches those owners and, if a
+ * holder dies, reclaims the lever by posting on its behalf so the treasure room is not
+ * left waiting for TIME_TREASURE_AVAILABLE to expire.
+ */
+#ifndef DUNGEON_LEVERS_H
+#define DUNGEON_LEVERS_H
+
+#include <errno.h>      // For errno, ESRCH
+#include <signal.h>     // For kill()
+#include <semaphore.h>  // For sem_t, sem_wait, sem_trywait, sem_post
+#include <stdbool.h>    // For bool type
+#include <sys/wait.h>   // For waitid(), WNOWAIT
+#include <time.h>       // For clock_gettime, CLOCK_REALTIME
+#include <unistd.h>     // For pid_t, getpid
+
+#include "dungeon_info.h"
+#include "dungeon_clock.h"
+#include "dungeon_settings.h"
+
+// Indices into dungeon->levers[] for /LeverOne and /LeverTwo.
+#define LEVER_ONE (0)
+#define LEVER_TWO (1)
+
+// lever_release result when the Dungeon Master had already reclaimed the lever.
+#define LEVER_RECLAIMED (1)
+
+/*
+ * lever_take - Takes a lever semaphore and records the caller as its owner.
+ * A holder that dies between the sem_wait and the owner store cannot be reclaimed,
+ * so the store happens immediately after the semaphore is acquired.
+ * @lever: The lever's owner record, e.g. &dungeon->levers[LEVER_ONE] of a Dungeon or a slot.
+ * @sem: The semaphore backing that lever.
+ * @blocking: Use sem_wait when true, sem_trywait when false.
+ * Returns true if the lever is now held by the caller.
+ */
+static inline bool lever_take(struct Lever *lever, sem_t *sem, bool blocking) {
+    int result = blocking ? sem_wait(sem) : sem_trywait(sem);
+    if (result != 0) {
+        return false;
+    }
+    __atomic_store_n(&lever->owner, getpid(), __ATOMIC_RELEASE);
+    return true;
+}
+
+/*
+ * lever_take_until - Waits for a lever like lever_take(..., true), but gives up once @deadline
+ * passes or *@running turns false. A plain sem_wait would block forever on a lever nobody
+ * releases, e.g. when the segment says the room is over but the semaphore was never posted.
+ * @lever: The lever's owner record, as for lever_take.
+ * @sem: The semaphore backing that lever.
+ * @deadline: When to stop waiting.
+ * @running: The dungeon's running flag, e.g. &dungeon->running.
+ * Returns true if the lever is now held by the caller.
+ */
+static inline bool lever_take_until(struct Lever *lever, sem_t *sem, const struct Deadline *deadline,
+                                    const bool *running) {
+    while (__atomic_load_n(running, __ATOMIC_RELAXED) && !deadline_passed(deadline)) {
+        // sem_timedwait only takes CLOCK_REALTIME, so wait in short slices and recheck.
+        struct timespec until;
+        clock_gettime(CLOCK_REALTIME, &until);
+        until.tv_nsec += CHARACTER_HOLD_POLL * NSEC_PER_USEC;
+        if (until.tv_nsec >= NSEC_PER_SEC) {
+            until.tv_sec++;
+            until.tv_nsec -= NSEC_PER_SEC;
+        }
+        if (sem_timedwait(sem, &until) == 0) {
+            __atomic_store_n(&lever->owner, getpid(), __ATOMIC_RELEASE);
+            return true;
+        }
+        if (errno != ETIMEDOUT && errno != EINTR) {
+            return false;
+        }
+    }
+    return false;
+}
+
+/*
+ * lever_release - Clears the caller's ownership of a lever and posts its semaphore.
+ * If the Dungeon Master already reclaimed the lever the post is skipped, so the
+ * semaphore can never be raised above one by a late release.
+ * @lever: The lever's owner record, as for lever_take.
+ * @sem: The semaphore backing that lever.
+ * Returns 0 on success, LEVER_RECLAIMED if the lever was no longer owned by the caller,
+ * or -1 (with errno set) if sem_post failed.
+ */
+static inline int lever_release(struct Lever *lever, sem_t *sem) {
+    pid_t expected = getpid();
+    if (!__atomic_compare_exchange_n(&lever->owner, &expected, 0,
+                                     false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        return LEVER_RECLAIMED;
+    }
+    return sem_post(sem);
+}
+
+/*
+ * lever_holder_alive - Checks whether a lever owner is still running.
+ * Children of the caller are checked with waitid(WNOWAIT) so that a crashed
+ * character is detected while it is still a zombie, without reaping it.
+ * @pid: PID recorded as the lever owner.
+ */
+static inline bool lever_holder_alive(pid_t pid) {
+    siginfo_t info;
+    info.si_pid = 0;
+    if (waitid(P_PID, pid, &info, WEXITED | WNOHANG | WNOWAIT) == 0) {
+        return info.si_pid == 0;
+    }
+    // Not our child: fall back to probing the PID.
+    return !(kill(pid, 0) == -1 && errno == ESRCH);
+}
+
+/*
+ * lever_reclaim_if_dead - Posts a lever on behalf of an owner that has died.
+ * @lever: The lever's owner record, as for lever_take.
+ * @sem: The semaphore backing that lever.
+ * Returns the PID of the dead owner that was reclaimed, or 0 if nothing was done.
+ */
+static inline pid_t lever_reclaim_if_dead(struct Lever *lever, sem_t *sem) {
+    pid_t owner = __atomic_load_n(&lever->owner, __ATOMIC_ACQUIRE);
+    if (owner == 0 || lever_holder_alive(owner)) {
+        return 0;
+    }
+    // Only one of the owner's release and this reclaim can win the exchange.
+    if (!__atomic_compare_exchange_n(&lever->owner, &owner, 0,
+                                     false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        return 0;
+    }
+    sem_post(sem);
+    return owner;
+}
+
+#endif
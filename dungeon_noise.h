@@ -0,0 +1,208 @@
+/*
+ * dungeon_noise.h - Background interference for benchmarks (noisy neighbours).
+ * Starts worker processes that compete with the game for a resource until they are stopped:
+ *
+ *   cpu    - spins on integer arithmetic, competing for CPU time
+ *   stream - streams through NOISE_STREAM_BYTES (a STREAM triad), competing for memory bandwidth
+ *   thrash - writes random cache lines of NOISE_THRASH_BYTES, evicting everyone else's cache
+ *
+ * A spec names a kind, optionally how many workers and which CPUs to pin them to, e.g.
+ * "cpu", "stream:2" or "thrash:2@0,1". Workers are spread over the listed CPUs in turn;
+ * without a list they keep the CPUs of the process that started them. Workers die with it.
+ */
+#ifndef DUNGEON_NOISE_H
+#define DUNGEON_NOISE_H
+
+#include <sched.h>      // For sched_setaffinity, cpu_set_t (needs _GNU_SOURCE)
+#include <signal.h>     // For kill, SIGKILL
+#include <stdio.h>      // For fprintf, perror
+#include <stdlib.h>     // For malloc, strtol
+#include <string.h>     // For strncmp, strcspn, memset
+#include <sys/prctl.h>  // For prctl, PR_SET_PDEATHSIG
+#include <sys/wait.h>   // For waitpid
+#include <unistd.h>     // For fork, _exit
+
+#include "dungeon_settings.h"
+
+#define NOISE_MAX_CPUS (64)
+#define NOISE_MAX_WORKERS (64)
+
+enum NoiseKind {
+    NOISE_CPU,
+    NOISE_STREAM,
+    NOISE_THRASH
+};
+
+// One kind of interference: how many workers and where.
+struct NoiseSpec {
+    enum NoiseKind kind;
+    int workers;
+    int cpus[NOISE_MAX_CPUS];  // CPUs to pin the workers to, in turn
+    int cpuCount;              // 0 leaves the workers unpinned
+};
+
+// The workers started for a set of specs.
+struct Noise {
+    pid_t pids[NOISE_MAX_WORKERS];
+    int count;
+};
+
+/*
+ * noise_kind_name - Returns the name of a kind as used in specs.
+ */
+static inline const char *noise_kind_name(enum NoiseKind kind) {
+    return kind == NOISE_CPU ? "cpu" : kind == NOISE_STREAM ? "stream" : "thrash";
+}
+
+/*
+ * noise_parse - Parses a spec of the form kind[:workers][@cpu,cpu,...].
+ * Returns 0 on success, -1 (with a message) if the spec is malformed.
+ */
+static inline int noise_parse(const char *text, struct NoiseSpec *spec) {
+    memset(spec, 0, sizeof(*spec));
+    spec->workers = 1;
+    size_t length = strcspn(text, ":@");
+    if (length == 3 && strncmp(text, "cpu", length) == 0) {
+        spec->kind = NOISE_CPU;
+    } else if (length == 6 && strncmp(text, "stream", length) == 0) {
+        spec->kind = NOISE_STREAM;
+    } else if (length == 6 && strncmp(text, "thrash", length) == 0) {
+        spec->kind = NOISE_THRASH;
+    } else {
+        fprintf(stderr, "NOISE: unknown kind in \"%s\"; use cpu, stream or thrash.\n", text);
+        return -1;
+    }
+    const char *rest = text + length;
+    char *end;
+    if (*rest == ':') {
+        spec->workers = (int)strtol(rest + 1, &end, 10);
+        rest = end;
+        if (spec->workers < 1 || spec->workers > NOISE_MAX_WORKERS) {
+            fprintf(stderr, "NOISE: \"%s\" needs 1 to %d workers.\n", text, NOISE_MAX_WORKERS);
+            return -1;
+        }
+    }
+    if (*rest == '@') {
+        do {
+            rest++;
+            int cpu = (int)strtol(rest, &end, 10);
+            if (end == rest || cpu < 0 || spec->cpuCount == NOISE_MAX_CPUS) {
+                fprintf(stderr, "NOISE: bad CPU list in \"%s\".\n", text);
+                return -1;
+            }
+            spec->cpus[spec->cpuCount++] = cpu;
+            rest = end;
+        } while (*rest == ',');
+    }
+    if (*rest != '\0') {
+        fprintf(stderr, "NOISE: unexpected \"%s\" in \"%s\".\n", rest, text);
+        return -1;
+    }
+    return 0;
+}
+
+/*
+ * noise_pin - Pins the calling process to one CPU.
+ * Returns 0 on success, -1 with errno set.
+ */
+static inline int noise_pin(int cpu) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return sched_setaffinity(0, sizeof(set), &set);
+}
+
+/*
+ * noise_work - Body of a worker; never returns.
+ */
+static inline void noise_work(enum NoiseKind kind) {
+    if (kind == NOISE_CPU) {
+        volatile unsigned long state = 1;
+        for (;;) {
+            state = state * 6364136223846793005UL + 1442695040888963407UL;
+        }
+    }
+    size_t bytes = kind == NOISE_STREAM ? NOISE_STREAM_BYTES : NOISE_THRASH_BYTES;
+    char *buffer = malloc(bytes);
+    if (buffer == NULL) {
+        perror("NOISE: malloc failed");
+        _exit(EXIT_FAILURE);
+    }
+    memset(buffer, 1, bytes); // Fault every page in before the measurement starts.
+    if (kind == NOISE_STREAM) {
+        // a = b + s * c over three arrays, each a third of the buffer.
+        size_t n = bytes / 3 / sizeof(double);
+        double *a = (double *)buffer, *b = a + n, *c = b + n;
+        for (;;) {
+            for (size_t i = 0; i < n; i++) {
+                a[i] = b[i] + 3.0 * c[i];
+            }
+            __asm__ volatile("" : : "r"(a) : "memory"); // Keep the stores.
+        }
+    }
+    // Thrash: one write to a random cache line at a time (xorshift64), so nothing stays cached.
+    size_t lines = bytes / DUNGEON_CACHE_LINE;
+    unsigned long state = 88172645463325252UL;
+    for (;;) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        ((volatile char *)buffer)[(state % lines) * DUNGEON_CACHE_LINE]++;
+    }
+}
+
+/*
+ * noise_stop - Kills and reaps every worker.
+ * Returns 0.
+ */
+static inline int noise_stop(struct Noise *noise) {
+    for (int i = 0; i < noise->count; i++) {
+        kill(noise->pids[i], SIGKILL);
+    }
+    for (int i = 0; i < noise->count; i++) {
+        waitpid(noise->pids[i], NULL, 0);
+    }
+    noise->count = 0;
+    return 0;
+}
+
+/*
+ * noise_start - Starts the workers of every spec.
+ * @noise: Filled in with the workers' PIDs.
+ * @specs: The specs.
+ * @count: Number of specs.
+ * Returns 0 on success, -1 if a worker could not be started (those started are stopped).
+ */
+static inline int noise_start(struct Noise *noise, const struct NoiseSpec *specs, int count) {
+    noise->count = 0;
+    pid_t parent = getpid();
+    for (int s = 0; s < count; s++) {
+        for (int w = 0; w < specs[s].workers; w++) {
+            if (noise->count == NOISE_MAX_WORKERS) {
+                fprintf(stderr, "NOISE: more than %d workers.\n", NOISE_MAX_WORKERS);
+                noise_stop(noise);
+                return -1;
+            }
+            pid_t pid = fork();
+            if (pid < 0) {
+                perror("NOISE: fork failed");
+                noise_stop(noise);
+                return -1;
+            }
+            if (pid == 0) {
+                prctl(PR_SET_PDEATHSIG, SIGKILL);
+                if (getppid() != parent) {
+                    _exit(EXIT_SUCCESS); // The parent is already gone.
+                }
+                if (specs[s].cpuCount > 0 && noise_pin(specs[s].cpus[w % specs[s].cpuCount]) == -1) {
+                    perror("NOISE: sched_setaffinity failed");
+                }
+                noise_work(specs[s].kind);
+            }
+            noise->pids[noise->count++] = pid;
+        }
+    }
+    return 0;
+}
+
+#endif
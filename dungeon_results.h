@@ -0,0 +1,293 @@
+/*
+ * dungeon_results.h - Columnar log of room outcomes.
+ * engine.c and master.c append one row per enemy, barrier or trap room they close when a
+ * results directory is set (RESULTS_DIR, or the DUNGEON_RESULTS environment variable).
+ * Rows are buffered column by column and written in chunks of up to RESULTS_CHUNK_ROWS rows,
+ * one file per column and chunk:
+ *
+ *   <dir>/<writer>-<chunk>.<column>.col
+ *
+ * where <writer> is unique to the process and run that wrote it. Each file is a
+ * struct ResultsColumnHeader (64 bytes, with the smallest and largest value of the chunk)
+ * followed by the packed little-endian values, so a reader can mmap a column and scan it as
+ * an array, and skip a whole chunk by its min/max. Files are written under a temporary name
+ * and renamed into place, and a chunk's kind column is renamed last, so a chunk whose kind
+ * file exists is complete. dungeon_stats.c (./dungeon-stats) aggregates them.
+ *
+ * Columns, one value per room:
+ *   game     int64   Game id: the engine's seed, or the master's PID << 32 | game number
+ *   round    int32   Room number within the game, from 0
+ *   kind     uint8   enum RoomType (dungeon_slots.h)
+ *   param    int64   Enemy: the monster's health. Barrier: the phrase's index in the
+ *                    engine's phrase list, its line's byte offset in the spell corpus
+ *                    (dungeon_corpus.h) tagged with RESULTS_CORPUS_PHRASE, or -1 for a
+ *                    generated phrase. Trap: the angle.
+ *   key      int32   Barrier: the Caesar key character. 0 otherwise.
+ *   answer   float64 Enemy: the Barbarian's attack. Barrier: the length of the Wizard's
+ *                    answer. Trap: the Rogue's last pick.
+ *   success  uint8   1 if the room was won
+ *   latency  int64   Nanoseconds from the room opening to its answer or its close
+ */
+#ifndef DUNGEON_RESULTS_H
+#define DUNGEON_RESULTS_H
+
+#include <errno.h>      // For errno, EEXIST
+#include <stdbool.h>    // For bool type
+#include <stdint.h>     // For int64_t, int32_t, uint8_t
+#include <stdio.h>      // For snprintf, fopen, fwrite, perror
+#include <stdlib.h>     // For malloc, free, getenv
+#include <string.h>     // For memcpy, memset
+#include <sys/stat.h>   // For mkdir
+#include <unistd.h>     // For getpid, fsync, unlink
+
+#include "dungeon_settings.h"  // For RESULTS_DIR, RESULTS_CHUNK_ROWS
+#include "dungeon_clock.h"     // For clock_now
+
+#define RESULTS_MAGIC ("DNGCOL1")
+#define RESULTS_PATH_MAX (4096)
+
+// Set in a barrier's param when the phrase is a corpus offset, so it never reads as a list index.
+#define RESULTS_CORPUS_PHRASE (1LL << 62)
+
+enum ResultsColumn {
+    RESULTS_GAME,
+    RESULTS_ROUND,
+    RESULTS_KIND,
+    RESULTS_PARAM,
+    RESULTS_KEY,
+    RESULTS_ANSWER,
+    RESULTS_SUCCESS,
+    RESULTS_LATENCY,
+    RESULTS_COLUMNS
+};
+
+enum ResultsType {
+    RESULTS_INT64,
+    RESULTS_INT32,
+    RESULTS_UINT8,
+    RESULTS_FLOAT64
+};
+
+// Start of every column file. The values follow at offset sizeof(struct ResultsColumnHeader).
+struct ResultsColumnHeader {
+    char magic[8];             // RESULTS_MAGIC
+    unsigned int type;         // enum ResultsType
+    unsigned int width;        // Bytes per value
+    unsigned long rows;        // Values in the chunk
+    double min;                // Smallest value in the chunk
+    double max;                // Largest value in the chunk
+    char reserved[24];         // Pads the header to 64 bytes, so the values stay aligned
+};
+
+// One room, as appended by the engines.
+struct ResultsRow {
+    long long game;
+    int round;
+    int kind;
+    long long param;
+    int key;
+    double answer;
+    bool success;
+    long long latency;
+};
+
+// Buffers the rows of the chunk being filled.
+struct ResultsWriter {
+    char dir[RESULTS_PATH_MAX];
+    char name[64];             // <writer> part of the file names
+    unsigned long chunks;      // Chunks written so far
+    unsigned long rows;        // Rows in the current chunk
+    void *columns[RESULTS_COLUMNS]; // RESULTS_CHUNK_ROWS values each, NULL when not open
+};
+
+/*
+ * results_column_name - Returns the file name part of a column.
+ */
+static inline const char *results_column_name(int column) {
+    static const char *const names[RESULTS_COLUMNS] = {
+        "game", "round", "kind", "param", "key", "answer", "success", "latency"
+    };
+    return names[column];
+}
+
+/*
+ * results_column_type - Returns the enum ResultsType of a column.
+ */
+static inline int results_column_type(int column) {
+    static const int types[RESULTS_COLUMNS] = {
+        RESULTS_INT64, RESULTS_INT32, RESULTS_UINT8, RESULTS_INT64,
+        RESULTS_INT32, RESULTS_FLOAT64, RESULTS_UINT8, RESULTS_INT64
+    };
+    return types[column];
+}
+
+/*
+ * results_type_width - Returns the bytes per value of an enum ResultsType.
+ */
+static inline size_t results_type_width(int type) {
+    return type == RESULTS_UINT8 ? 1 : type == RESULTS_INT32 ? 4 : 8;
+}
+
+/*
+ * results_dir - Returns the results directory to write to, or NULL if results are off.
+ * The DUNGEON_RESULTS environment variable overrides RESULTS_DIR; an empty value turns them off.
+ */
+static inline const char *results_dir(void) {
+    const char *dir = getenv("DUNGEON_RESULTS");
+    if (dir == NULL) {
+        dir = RESULTS_DIR;
+    }
+    return (dir != NULL && dir[0] != '\0') ? dir : NULL;
+}
+
+/*
+ * results_value - Returns value @row of a column buffer as a double, for its min/max.
+ */
+static inline double results_value(const void *values, int type, unsigned long row) {
+    switch (type) {
+    case RESULTS_INT64: return (double)((const int64_t *)values)[row];
+    case RESULTS_INT32: return (double)((const int32_t *)values)[row];
+    case RESULTS_UINT8: return (double)((const uint8_t *)values)[row];
+    default: return ((const double *)values)[row];
+    }
+}
+
+/*
+ * results_close_writer - Frees a writer's buffers without writing them.
+ */
+static inline void results_close_writer(struct ResultsWriter *writer) {
+    for (int c = 0; c < RESULTS_COLUMNS; c++) {
+        free(writer->columns[c]);
+        writer->columns[c] = NULL;
+    }
+    writer->rows = 0;
+}
+
+/*
+ * results_open - Prepares a writer for @dir, creating the directory if needed.
+ * Returns 0 on success, -1 (with a message) otherwise.
+ */
+static inline int results_open(struct ResultsWriter *writer, const char *dir) {
+    memset(writer, 0, sizeof(*writer));
+    if (snprintf(writer->dir, sizeof(writer->dir), "%s", dir) >= (int)sizeof(writer->dir)) {
+        fprintf(stderr, "RESULTS: directory name is too long.\n");
+        return -1;
+    }
+    if (mkdir(dir, 0755) == -1 && errno != EEXIST) {
+        perror("RESULTS: mkdir failed");
+        return -1;
+    }
+    snprintf(writer->name, sizeof(writer->name), "%d-%llx", getpid(), (unsigned long long)clock_now());
+    for (int c = 0; c < RESULTS_COLUMNS; c++) {
+        writer->columns[c] = malloc(RESULTS_CHUNK_ROWS * results_type_width(results_column_type(c)));
+        if (writer->columns[c] == NULL) {
+            perror("RESULTS: malloc failed");
+            results_close_writer(writer);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * results_path - Builds the path of one column file of the current chunk.
+ * @suffix: "" for the final name, ".tmp" while it is written.
+ */
+static inline void results_path(const struct ResultsWriter *writer, int column, const char *suffix,
+                                char *path, size_t size) {
+    snprintf(path, size, "%s/%s-%lu.%s.col%s", writer->dir, writer->name, writer->chunks,
+             results_column_name(column), suffix);
+}
+
+/*
+ * results_flush - Writes the buffered rows as a chunk and starts a new one.
+ * Returns 0 on success (or with nothing to write), -1 if a column could not be written.
+ */
+static inline int results_flush(struct ResultsWriter *writer) {
+    if (writer->rows == 0 || writer->columns[0] == NULL) {
+        return 0;
+    }
+    char temp[RESULTS_PATH_MAX + 96], path[RESULTS_PATH_MAX + 96];
+    int written = 0;
+    for (; written < RESULTS_COLUMNS; written++) {
+        int type = results_column_type(written);
+        struct ResultsColumnHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, RESULTS_MAGIC, sizeof(RESULTS_MAGIC));
+        header.type = (unsigned int)type;
+        header.width = (unsigned int)results_type_width(type);
+        header.rows = writer->rows;
+        header.min = header.max = results_value(writer->columns[written], type, 0);
+        for (unsigned long row = 1; row < writer->rows; row++) {
+            double value = results_value(writer->columns[written], type, row);
+            header.min = value < header.min ? value : header.min;
+            header.max = value > header.max ? value : header.max;
+        }
+        results_path(writer, written, ".tmp", temp, sizeof(temp));
+        FILE *out = fopen(temp, "wb");
+        if (out == NULL) {
+            perror("RESULTS: fopen failed");
+            break;
+        }
+        bool ok = fwrite(&header, sizeof(header), 1, out) == 1 &&
+                  fwrite(writer->columns[written], header.width, writer->rows, out) == writer->rows &&
+                  fflush(out) == 0 && fsync(fileno(out)) == 0;
+        if (fclose(out) != 0 || !ok) {
+            perror("RESULTS: write failed");
+            unlink(temp);
+            break;
+        }
+    }
+    // Rename the kind column last: readers take a chunk whose kind file exists as complete.
+    bool ok = written == RESULTS_COLUMNS;
+    for (int c = 0; c <= RESULTS_COLUMNS; c++) {
+        int column = c == RESULTS_COLUMNS ? RESULTS_KIND : c;
+        if (c == RESULTS_KIND || column >= written) {
+            continue;
+        }
+        results_path(writer, column, ".tmp", temp, sizeof(temp));
+        results_path(writer, column, "", path, sizeof(path));
+        if (!ok || rename(temp, path) == -1) {
+            if (ok) {
+                perror("RESULTS: rename failed");
+                ok = false;
+            }
+            unlink(temp); // Without its kind file the chunk is ignored.
+        }
+    }
+    writer->chunks++;
+    writer->rows = 0;
+    return ok ? 0 : -1;
+}
+
+/*
+ * results_append - Adds one room, writing the chunk once it holds RESULTS_CHUNK_ROWS rows.
+ * Returns 0 on success, -1 if a full chunk could not be written.
+ */
+static inline int results_append(struct ResultsWriter *writer, const struct ResultsRow *row) {
+    if (writer->columns[0] == NULL) {
+        return 0;
+    }
+    unsigned long i = writer->rows++;
+    ((int64_t *)writer->columns[RESULTS_GAME])[i] = row->game;
+    ((int32_t *)writer->columns[RESULTS_ROUND])[i] = row->round;
+    ((uint8_t *)writer->columns[RESULTS_KIND])[i] = (uint8_t)row->kind;
+    ((int64_t *)writer->columns[RESULTS_PARAM])[i] = row->param;
+    ((int32_t *)writer->columns[RESULTS_KEY])[i] = row->key;
+    ((double *)writer->columns[RESULTS_ANSWER])[i] = row->answer;
+    ((uint8_t *)writer->columns[RESULTS_SUCCESS])[i] = row->success ? 1 : 0;
+    ((int64_t *)writer->columns[RESULTS_LATENCY])[i] = row->latency;
+    return writer->rows == RESULTS_CHUNK_ROWS ? results_flush(writer) : 0;
+}
+
+/*
+ * results_close - Writes the last chunk and frees the writer.
+ * Returns 0 on success, -1 if the chunk could not be written.
+ */
+static inline int results_close(struct ResultsWriter *writer) {
+    int result = results_flush(writer);
+    results_close_writer(writer);
+    return result;
+}
+
+#endif
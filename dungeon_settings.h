@@ -36,12 +36,51 @@
 //The maximum angle used for the rogue's picking challenge. Default: 100
 #define MAX_PICK_ANGLE (100)
 
+//File where the rogue keeps a histogram of trap angles it has unlocked, across rounds and games.
+//The rogue uses it to choose where to probe first. Delete the file to forget the history. Default: "rogue_history.bin"
+#define ROGUE_HISTORY_FILE ("rogue_history.bin")
+
 //This is the signal that the dungeon will use to communicate with user processes. Default: SIGUSR1
 #define DUNGEON_SIGNAL (SIGUSR1)
 
 //This is the signal that the dungeon will use to tell the processes to use their semaphores. Default: SIGUSR2
 #define SEMAPHORE_SIGNAL (SIGUSR2)
 
+//Realtime signals engine.c sends in place of DUNGEON_SIGNAL and SEMAPHORE_SIGNAL when
+//DUNGEON_SIGNAL_PAYLOADS is set. They queue instead of merging and carry the room they are
+//about (see dungeon_signals.h). Default: SIGRTMIN and SIGRTMIN + 1
+#define DUNGEON_RT_SIGNAL (SIGRTMIN)
+#define SEMAPHORE_RT_SIGNAL (SIGRTMIN + 1)
+
+//Whether engine.c signals rooms with the queued realtime signals above (true) or with
+//DUNGEON_SIGNAL and SEMAPHORE_SIGNAL like dungeon.o (false). Default: true
+#define DUNGEON_SIGNAL_PAYLOADS (true)
+
+//Whether the characters block the room signals and read them from a signalfd in their main
+//loop (true), or do each room's work inside a signal handler (false). Default: true
+#define CHARACTER_SIGNALFD (true)
+
+//Most room notifications a character reads from its signalfd at once. Default: 16
+#define SIGNAL_BATCH (16)
+
+//How the characters wait for rooms: WAIT_SIGNAL, WAIT_FUTEX, WAIT_SPIN, WAIT_PARK or WAIT_EVENTFD
+//(see character.h). The DUNGEON_WAIT environment variable overrides it. Default: WAIT_SIGNAL
+#define CHARACTER_WAIT_STRATEGY (WAIT_SIGNAL)
+
+//Longest a character waits (in microseconds) before rechecking whether the dungeon is still running. Default: 100000
+#define CHARACTER_WAIT_TIMEOUT (100000)
+
+//How long (in microseconds) the park strategy spins before it sleeps. Default: 50
+#define CHARACTER_SPIN_TIME (50)
+
+//How often (in microseconds) a character holding a lever checks whether the Rogue is done. Default: 1000
+#define CHARACTER_HOLD_POLL (1000)
+
+//Shared object the Wizard and Rogue load their decode and search strategies from (see
+//character_plugin.h), e.g. "./plugin_margin.so". The DUNGEON_PLUGIN environment variable
+//overrides it. NULL uses the built-in logic. Default: NULL
+#define CHARACTER_PLUGIN (NULL)
+
 //The minimum number of times the barbarian will run the dungeon. Default: 2
 #define MIN_BARBARIAN_RUNS (2)
 
@@ -61,4 +100,110 @@
 //This is how many points you get for unblocking the semaphores after getting the treasure at the end. Default: 4
 #define POINTS_FOR_POSTING_SEMAPHORES (4)
 
+//Lay out each game of /DungeonSlots compactly (see dungeon_slots.h): the control fields in one
+//cache line and the spells out of line. Master, host and exporter must be built with the same value,
+//e.g. `make master host exporter SLOT_FLAGS=-DCOMPACT_SLOTS=true`. Default: false
+#ifndef COMPACT_SLOTS
+#define COMPACT_SLOTS (false)
+#endif
+
+//Size in bytes of a cache line, which the compact slot layout is aligned to. Default: 64
+#define DUNGEON_CACHE_LINE (64)
+
+//How long (in microseconds) a host worker thread naps when none of its characters could make progress.
+//Lower values answer rooms sooner but burn more CPU while games are idle. Default: 100
+#define HOST_IDLE_SLEEP (100)
+
+//How often (in microseconds) the Dungeon Master checks whether a character died while holding a lever.
+//A lever held by a dead character is posted on its behalf so the treasure room does not stall. Default: 10000
+#define LEVER_WATCH_INTERVAL (10000)
+
+//How often (in microseconds) the multi-game master checks each open room for an answer or a new trap pick. Default: 100
+#define MASTER_POLL_INTERVAL (100)
+
+//How soon (in microseconds) after a room closes the multi-game master must open the game's next room. Default: 1000
+#define MASTER_DISPATCH_BUDGET (1000)
+
+//How late (in microseconds) the multi-game master may run a room check before it counts as a missed deadline. Default: 1000
+#define MASTER_DEADLINE_SLACK (1000)
+
+//The share of the multi-game master's time that admitted games may need, by the EDF utilization test.
+//Games that would push the estimate above this wait for a running game to finish. Default: 0.7
+#define MASTER_MAX_UTILIZATION (0.7)
+
+//How long (in seconds) a game may wait for admission before the multi-game master rejects it. Default: 30
+#define MASTER_ADMISSION_TIMEOUT (30)
+
+//How long (in seconds) the multi-game master waits after creating the slots, so hosts can attach. Default: 1
+#define MASTER_START_DELAY (1)
+
+//File the exporter writes the /DungeonSlots counters to, in the Prometheus text format. Point it
+//into node_exporter's --collector.textfile.directory; the -o option overrides it. Default: "dungeon.prom"
+#define EXPORTER_FILE ("dungeon.prom")
+
+//How often (in milliseconds) the exporter rewrites its file. Default: 1000
+#define EXPORTER_INTERVAL (1000)
+
+//Latency (in microseconds, from a room's intended arrival to its answer) the load generator's p99
+//must stay within for a rate to count as sustainable. The -l option overrides it. Default: 10000
+#define LOADGEN_SLO (10000)
+
+//How long (in microseconds) before each arrival the load generator stops sleeping and yields
+//instead, so its own wake-up delay does not count as room latency. Default: 200
+#define LOADGEN_SPIN (200)
+
+//Bytes each "stream" noise worker streams through (see dungeon_noise.h). Should be well beyond
+//the last-level cache so every pass goes to memory. Default: 192 MiB
+#define NOISE_STREAM_BYTES ((size_t)192 << 20)
+
+//Bytes each "thrash" noise worker writes random cache lines of. Should be a few times the
+//last-level cache. Default: 64 MiB
+#define NOISE_THRASH_BYTES ((size_t)64 << 20)
+
+//Whether engine.c stages each room and reports the one before it while the characters answer
+//the current room (true), or does both between rooms like dungeon.o (false). Default: true
+#define ENGINE_PIPELINE_ROOMS (true)
+
+//Whether engine.o's RunDungeon publishes snapshots of the game to /DungeonSpectate for spectators
+//(see dungeon_spectate.h and spectator.c). Default: true
+#define ENGINE_SPECTATE (true)
+
+//Number of snapshots the spectator ring keeps. A spectator that falls further behind skips
+//ahead and reports what it missed. Default: 64
+#define SPECTATOR_RING_SLOTS (64)
+
+//How often (in microseconds) spectator.c checks the ring for new snapshots. Default: 1000
+#define SPECTATOR_POLL (1000)
+
+//Directory engine.c and master.c write each room's outcome to, in columns (see dungeon_results.h
+//and ./dungeon-stats). The DUNGEON_RESULTS environment variable overrides it. NULL writes nothing. Default: NULL
+#define RESULTS_DIR (NULL)
+
+//Rows per chunk of the results columns. Default: 65536
+#define RESULTS_CHUNK_ROWS (65536)
+
+//Text file engine.c and master.c draw barrier phrases from, one per line, instead of their built-in
+//phrases (see dungeon_corpus.h). The DUNGEON_CORPUS environment variable overrides it. NULL uses the
+//built-in phrases. Default: NULL
+#define SPELL_CORPUS (NULL)
+
+//How often (in microseconds) engine.c checks whether a character has answered the current room.
+//The room ends as soon as the answer is in; its time limit only applies to characters that never answer. Default: 50
+#define ENGINE_ANSWER_POLL (50)
+
+//Whether engine.c judges the rogue's pick as soon as a new one is published (true), or once
+//every TIME_BETWEEN_ROGUE_TICKS like dungeon.o (false). Default: true
+#define ENGINE_TRAP_EVENTS (true)
+
+//Whether engine.c sizes its trap tick by how quickly each game's rogue answers a judgement,
+//instead of always waiting TIME_BETWEEN_ROGUE_TICKS. Default: true
+#define ENGINE_ADAPTIVE_TICK (true)
+
+//The adaptive tick is this many times the rogue's average response time. Default: 2.0
+#define ENGINE_TICK_FACTOR (2.0)
+
+//Bounds (in microseconds) for the adaptive tick. Default: 200 and 20000
+#define ENGINE_TICK_MIN (200)
+#define ENGINE_TICK_MAX (20000)
+
 #endif
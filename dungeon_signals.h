@@ -0,0 +1,172 @@
+/*
+ * dungeon_signals.h - Realtime room signals that carry which room they are about.
+ * DUNGEON_SIGNAL and SEMAPHORE_SIGNAL are standard signals, so two sent before the handler
+ * runs arrive as one, and the character can only guess from shared memory what it missed.
+ * With DUNGEON_SIGNAL_PAYLOADS, engine.c sends DUNGEON_RT_SIGNAL and SEMAPHORE_RT_SIGNAL with
+ * sigqueue instead. Realtime signals are queued one per send, and each carries the room's
+ * sequence number, its enum RoomType and the slot index packed into sival_int:
+ *
+ *   bits  0..15  low 16 bits of Dungeon.roomSeq
+ *   bits 16..19  enum RoomType
+ *   bits 20..30  slot index (0 for a standalone game)
+ *
+ * Characters accept both kinds of signal, so they still work with dungeon.o. With
+ * CHARACTER_SIGNALFD they block all four and read them from a signalfd in their main loop
+ * (room_signal_fd, room_signal_loop) instead of doing the work inside a signal handler.
+ */
+#ifndef DUNGEON_SIGNALS_H
+#define DUNGEON_SIGNALS_H
+
+#include <errno.h>         // For errno, EINTR
+#include <signal.h>        // For union sigval, sigprocmask, SIGRTMIN
+#include <stdbool.h>       // For bool type
+#include <stdio.h>         // For printf
+#include <sys/signalfd.h>  // For signalfd, struct signalfd_siginfo
+#include <unistd.h>        // For read
+
+#include "dungeon_info.h"
+#include "dungeon_settings.h"
+#include "dungeon_slots.h"
+
+#define ROOM_SIGNAL_SEQ_BITS (16)
+#define ROOM_SIGNAL_SEQ_MASK ((1u << ROOM_SIGNAL_SEQ_BITS) - 1)
+
+// A decoded realtime room signal.
+struct RoomSignal {
+    unsigned int seq;   // Low ROOM_SIGNAL_SEQ_BITS bits of the room's roomSeq
+    int type;           // enum RoomType
+    int slot;           // Slot index of the game
+};
+
+/*
+ * room_signal_encode - Packs a room into the value sent with sigqueue.
+ * @seq: The room's roomSeq.
+ * @type: The room's enum RoomType.
+ * @slot: Slot index of the game, 0 for a standalone game.
+ */
+static inline union sigval room_signal_encode(unsigned int seq, int type, int slot) {
+    union sigval value;
+    value.sival_int = (int)((seq & ROOM_SIGNAL_SEQ_MASK) | ((unsigned int)(type & 0xf) << 16) |
+                            ((unsigned int)(slot & 0x7ff) << 20));
+    return value;
+}
+
+/*
+ * room_signal_decode - Unpacks the value of a realtime room signal.
+ */
+static inline struct RoomSignal room_signal_decode(union sigval value) {
+    unsigned int bits = (unsigned int)value.sival_int;
+    struct RoomSignal signal = {bits & ROOM_SIGNAL_SEQ_MASK, (int)((bits >> 16) & 0xf), (int)((bits >> 20) & 0x7ff)};
+    return signal;
+}
+
+/*
+ * room_signal_seq - Widens a signal's sequence number using the latest full roomSeq.
+ * A queued signal is never older than the current room by 2^16 rooms, so the full number
+ * is the latest one minus the distance between their low bits.
+ * @signal: The decoded signal.
+ * @latest: Dungeon.roomSeq as read now.
+ */
+static inline unsigned int room_signal_seq(const struct RoomSignal *signal, unsigned int latest) {
+    return latest - ((latest - signal->seq) & ROOM_SIGNAL_SEQ_MASK);
+}
+
+/*
+ * room_signal_current - Works out which room a realtime signal is about.
+ * @value: The signal's payload (si_value, or ssi_int from a signalfd).
+ * @dungeon: The game's shared Dungeon.
+ * @room: Set to the room's full sequence number.
+ * Returns true if that room is still the current one, false if a newer room has opened since
+ * (the signal is stale and should be dropped).
+ */
+static inline bool room_signal_current(union sigval value, struct Dungeon *dungeon, unsigned int *room) {
+    struct RoomSignal signal = room_signal_decode(value);
+    unsigned int latest = __atomic_load_n(&dungeon->roomSeq, __ATOMIC_ACQUIRE);
+    *room = room_signal_seq(&signal, latest);
+    return *room == latest;
+}
+
+/*
+ * room_signal_classic - Maps a realtime room signal to the standard signal it stands for.
+ * Returns DUNGEON_SIGNAL, SEMAPHORE_SIGNAL, or signum unchanged.
+ */
+static inline int room_signal_classic(int signum) {
+    if (signum == DUNGEON_RT_SIGNAL) {
+        return DUNGEON_SIGNAL;
+    }
+    if (signum == SEMAPHORE_RT_SIGNAL) {
+        return SEMAPHORE_SIGNAL;
+    }
+    return signum;
+}
+
+/*
+ * room_signal_fd - Blocks the room signals and returns a signalfd that reads them instead.
+ * Covers DUNGEON_SIGNAL, SEMAPHORE_SIGNAL and their realtime versions; SIGINT keeps its
+ * handler, so a blocked read returns with EINTR when the character is told to stop.
+ * Returns the descriptor, or -1 with errno set.
+ */
+static inline int room_signal_fd(void) {
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, DUNGEON_SIGNAL);
+    sigaddset(&set, SEMAPHORE_SIGNAL);
+    sigaddset(&set, DUNGEON_RT_SIGNAL);
+    sigaddset(&set, SEMAPHORE_RT_SIGNAL);
+    if (sigprocmask(SIG_BLOCK, &set, NULL) == -1) {
+        return -1;
+    }
+    return signalfd(-1, &set, SFD_CLOEXEC);
+}
+
+/*
+ * room_signal_loop - Serves rooms read from a room_signal_fd descriptor until the game ends.
+ * Reads up to SIGNAL_BATCH pending notifications at a time. Realtime signals are served for
+ * the room in their payload and dropped when that room has closed; plain signals are served
+ * for the current room. The work runs here, in the main loop, rather than in a handler.
+ * @fd: Descriptor from room_signal_fd.
+ * @dungeon: The game's shared Dungeon.
+ * @exit_flag: Set by the character's SIGINT handler.
+ * @serve: The character's serve function, given DUNGEON_SIGNAL or SEMAPHORE_SIGNAL and the room.
+ * @label: Prefix for the summary line, e.g. "[BARBARIAN]".
+ * Returns 0 when the game ended or the character was interrupted, -1 if reading failed.
+ */
+static inline int room_signal_loop(int fd, struct Dungeon *dungeon, volatile sig_atomic_t *exit_flag,
+                                   void (*serve)(int signum, unsigned int room), const char *label) {
+    struct signalfd_siginfo batch[SIGNAL_BATCH];
+    unsigned long served = 0, dropped = 0, batched = 0;
+    int result = 0;
+    while (dungeon->running && *exit_flag == 0) {
+        ssize_t got = read(fd, batch, sizeof(batch));
+        if (got < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            result = -1;
+            break;
+        }
+        size_t count = (size_t)got / sizeof(batch[0]);
+        if (count > 1) {
+            batched++;
+        }
+        for (size_t i = 0; i < count && *exit_flag == 0; i++) {
+            int signum = (int)batch[i].ssi_signo;
+            unsigned int room = __atomic_load_n(&dungeon->roomSeq, __ATOMIC_ACQUIRE);
+            if (signum == DUNGEON_RT_SIGNAL || signum == SEMAPHORE_RT_SIGNAL) {
+                union sigval value;
+                value.sival_int = batch[i].ssi_int;
+                if (!room_signal_current(value, dungeon, &room)) {
+                    dropped++;
+                    continue;
+                }
+            }
+            served++;
+            serve(room_signal_classic(signum), room);
+        }
+    }
+    printf("%s Served %lu rooms from the signalfd (%lu stale dropped, %lu reads returned several).\n",
+           label, served, dropped, batched);
+    return result;
+}
+
+#endif
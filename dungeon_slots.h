@@ -0,0 +1,181 @@
+/*
+ * dungeon_slots.h - Layout of the multi-game shared memory segment.
+ * One engine can run many games at once, each in its own DungeonSlot. Characters hosted in
+ * a single process (see host.c) cannot be told about a room with a signal, so each slot
+ * announces its rooms with a sequence number instead:
+ *
+ *   1. The engine fills in the room's data in slot->dungeon (enemy, barrier, trap or
+ *      treasure) and its roomDeadline.
+ *   2. It stores the room type in slot->roomType and the current time in slot->roomOpened,
+ *      then increments slot->roomSeq with release ordering. The characters poll roomSeq to
+ *      notice the new room; roomOpened lets them measure how long they took to answer.
+ *   3. The character whose room it is answers in slot->dungeon exactly as it would for
+ *      dungeon.o.
+ *
+ * Traps use a stricter handshake than dungeon.o. The engine only evaluates a pick after
+ * the rogue sets trap.direction to 't', or to 'w' for the first pick of a trap. Each
+ * 'u' or 'd' therefore always describes the pick currently in rogue.pick.
+ *
+ * The engine places the first pick of a trap at MAX_PICK_ANGLE / 2.
+ *
+ * The levers of each slot are process-shared semaphores kept inside the slot. The engine
+ * initializes them with sem_init.
+ *
+ * A slot is reused when its game ends: the engine clears slot->dungeon and starts the next
+ * game there, and roomSeq keeps counting. The engine keeps its scheduler counters in
+ * slots->stats and the hosts keep theirs in slots->host, so other processes (see exporter.c)
+ * can read them while games run.
+ *
+ * With COMPACT_SLOTS, slot->dungeon is a struct CompactDungeon instead of a struct Dungeon:
+ * the same control fields under the same names, packed with roomSeq, roomType and
+ * roomOpened into the slot's first cache line, and the two spells moved out of line to an
+ * array after the slots. A room then touches about two cache lines instead of about four
+ * (see the master's "Slot layout" report line). Spells are always reached through
+ * dungeon_slot_barrier and dungeon_slot_wizard, which work with either layout. The master
+ * records the layout in slots->layout, and a host built with another one refuses to attach.
+ */
+#ifndef DUNGEON_SLOTS_H
+#define DUNGEON_SLOTS_H
+
+#include <semaphore.h>  // For sem_t
+#include <stdbool.h>    // For bool type
+#include <stddef.h>     // For size_t
+
+#include "dungeon_info.h"
+#include "dungeon_settings.h"  // For COMPACT_SLOTS
+#include "dungeon_histogram.h" // For the hosts' latency histogram
+
+//Name of the shared memory segment that holds all the slots.
+#define DUNGEON_SLOTS_SHM_NAME ("/DungeonSlots")
+
+// The kind of room a slot's roomSeq announced.
+enum RoomType {
+    ROOM_NONE = 0,
+    ROOM_ENEMY,
+    ROOM_BARRIER,
+    ROOM_TRAP,
+    ROOM_TREASURE
+};
+
+#if COMPACT_SLOTS
+
+// Control fields of one game, named as in struct Dungeon so the same code serves either layout.
+struct CompactDungeon {
+    bool running;
+    struct Trap trap;
+    char treasure[4];
+    char spoils[4];
+    pid_t dungeonPID;
+    struct Barbarian barbarian;
+    struct Rogue rogue;
+    struct Enemy enemy;
+    int spellLength;
+    struct Lever levers[2];
+    long long roomDeadline;
+};
+typedef struct CompactDungeon SlotDungeon;
+
+struct DungeonSlot {
+    SlotDungeon dungeon;      // Control fields, 48 bytes
+    unsigned int roomSeq;     // Incremented by the engine each time a room opens
+    int roomType;             // enum RoomType of the room roomSeq announced
+    long long roomOpened;     // CLOCK_MONOTONIC time (ns) the room was announced, 0 if unknown
+    sem_t levers[2];          // Lever One and Lever Two, on the second line
+} __attribute__((aligned(DUNGEON_CACHE_LINE)));
+
+// The spells of one game, in the array that follows slots[].
+struct SlotSpells {
+    char barrier[SPELL_BUFFER_SIZE + 1];  // As Dungeon.barrier.spell
+    char wizard[SPELL_BUFFER_SIZE];       // As Dungeon.wizard.spell
+} __attribute__((aligned(DUNGEON_CACHE_LINE)));
+
+#else
+
+typedef struct Dungeon SlotDungeon;
+
+struct DungeonSlot {
+    SlotDungeon dungeon;      // Same game state the single-game characters use
+    sem_t levers[2];          // Lever One and Lever Two for this game's treasure room
+    unsigned int roomSeq;     // Incremented by the engine each time a room opens
+    int roomType;             // enum RoomType of the room roomSeq announced
+    long long roomOpened;     // CLOCK_MONOTONIC time (ns) the room was announced, 0 if unknown
+};
+
+#endif
+
+// Identifies the slot and header layout a segment was created with.
+#define DUNGEON_SLOTS_LAYOUT ((unsigned int)(sizeof(struct DungeonSlot) | sizeof(struct DungeonSlots) << 16) | \
+                              (COMPACT_SLOTS ? 0x80000000u : 0u))
+
+// Counters kept by the multi-game master (see master.c). Written with relaxed atomics.
+struct SchedulerStats {
+    unsigned long roomsOpened;      // Rooms announced across all games
+    unsigned long roomsPassed;      // Rooms the characters answered correctly in time
+    unsigned long roomsFailed;      // Rooms that closed without a correct answer
+    unsigned long missedDispatch;   // Rooms opened more than MASTER_DISPATCH_BUDGET after the previous one closed
+    unsigned long missedVerify;     // Room checks run more than MASTER_DEADLINE_SLACK past the room's deadline
+    unsigned long missedTrapJudge;  // Trap picks judged more than MASTER_DEADLINE_SLACK past their tick
+    unsigned long gamesAdmitted;    // Games given a slot
+    unsigned long gamesDeferred;    // Games that had to wait for admission at least once
+    unsigned long gamesRejected;    // Games that waited longer than MASTER_ADMISSION_TIMEOUT
+    unsigned long gamesFinished;    // Games that played their treasure room
+};
+
+// Counters kept by the hosts (see host.c). Written with relaxed atomics.
+struct HostStats {
+    unsigned long hostsAttached;    // Hosts that have attached to the segment
+    unsigned long roomsCompleted[ROLE_COUNT]; // Rooms answered, by enum CharacterRole
+    unsigned long leverTakes;       // Levers taken in treasure rooms
+    unsigned long leverWaits;       // Lever takes that had to wait for a lever to come free
+    unsigned long leverWaitNs;      // Time spent waiting for those levers, in ns
+    unsigned long workersCrashed;   // Character processes (host -p) killed by a signal
+    struct LatencyHistogram latency; // Room open to room complete
+};
+
+struct DungeonSlots {
+    bool running;             // Cleared by the engine when every game has finished
+    int count;                // Number of entries in slots[]
+    unsigned int layout;      // DUNGEON_SLOTS_LAYOUT of the engine that created the segment
+    struct SchedulerStats stats; // Scheduler counters of the engine
+    struct HostStats host;    // Counters of the hosts serving the slots
+    struct DungeonSlot slots[];
+};
+
+/*
+ * dungeon_slots_size - Returns the size of a slots segment holding count games.
+ */
+static inline size_t dungeon_slots_size(int count) {
+    size_t size = sizeof(struct DungeonSlots) + (size_t)count * sizeof(struct DungeonSlot);
+#if COMPACT_SLOTS
+    size += (size_t)count * sizeof(struct SlotSpells);
+#endif
+    return size;
+}
+
+/*
+ * dungeon_slot_barrier - Returns the barrier spell of @slot (SPELL_BUFFER_SIZE + 1 bytes).
+ */
+static inline char *dungeon_slot_barrier(struct DungeonSlots *slots, struct DungeonSlot *slot) {
+#if COMPACT_SLOTS
+    struct SlotSpells *spells = (struct SlotSpells *)&slots->slots[slots->count];
+    return spells[slot - slots->slots].barrier;
+#else
+    (void)slots;
+    return slot->dungeon.barrier.spell;
+#endif
+}
+
+/*
+ * dungeon_slot_wizard - Returns the wizard's spell of @slot (SPELL_BUFFER_SIZE bytes).
+ */
+static inline char *dungeon_slot_wizard(struct DungeonSlots *slots, struct DungeonSlot *slot) {
+#if COMPACT_SLOTS
+    struct SlotSpells *spells = (struct SlotSpells *)&slots->slots[slots->count];
+    return spells[slot - slots->slots].wizard;
+#else
+    (void)slots;
+    return slot->dungeon.wizard.spell;
+#endif
+}
+
+#endif
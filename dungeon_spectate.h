@@ -0,0 +1,118 @@
+/*
+ * dungeon_spectate.h - Snapshot ring for spectators of a game.
+ * Spectators (overlays, analytics) must not read /DungeonMem: every line they pull in is one
+ * the characters and the engine are writing, and each read takes it away from them. Instead,
+ * engine.c publishes a snapshot of the game into /DungeonSpectate whenever its state changes:
+ * a room opening or closing, a trap pick being judged, a treasure letter and the end of the
+ * game. A snapshot holds only what the engine already knows, so publishing reads nothing back
+ * from /DungeonMem.
+ *
+ * The segment is a ring of SPECTATOR_RING_SLOTS snapshots. Snapshot n goes to slot
+ * n % SPECTATOR_RING_SLOTS and is never changed afterwards, until the writer comes round to
+ * that slot again. Each slot carries a version (a seqlock) that is odd while the slot is
+ * written and 2n + 2 once snapshot n is complete, and ring->head counts the snapshots
+ * published. The engine never waits for spectators, and any number of spectators read the ring
+ * without locks or writes: a reader that falls a whole ring behind sees a newer version in
+ * the slot it wanted and knows which snapshots it missed.
+ */
+#ifndef DUNGEON_SPECTATE_H
+#define DUNGEON_SPECTATE_H
+
+#include <stdbool.h>    // For bool type
+#include <string.h>     // For memcpy
+#include <sys/types.h>  // For pid_t
+
+#include "dungeon_info.h"      // For enum CharacterRole
+#include "dungeon_settings.h"  // For SPELL_BUFFER_SIZE, SPECTATOR_RING_SLOTS, DUNGEON_CACHE_LINE
+
+//Name of the shared memory segment the engine publishes snapshots to.
+#define DUNGEON_SPECTATE_SHM_NAME ("/DungeonSpectate")
+
+// What changed when a snapshot was taken.
+enum SpectatorEvent {
+    SPECTATE_GAME_STARTED = 0,
+    SPECTATE_ROOM_OPENED,
+    SPECTATE_ROOM_CLOSED,
+    SPECTATE_PICK_JUDGED,
+    SPECTATE_TREASURE,
+    SPECTATE_GAME_OVER
+};
+
+// The state of a game at one moment.
+struct SpectatorSnapshot {
+    unsigned long serial;      // Position in the stream of snapshots, from 0
+    long long time;            // CLOCK_MONOTONIC time (ns) it was taken
+    int event;                 // enum SpectatorEvent
+    int roomType;              // enum RoomType (dungeon_slots.h) of the current room, ROOM_NONE between games
+    int room;                  // Rooms opened so far, including the current one
+    bool passed;               // SPECTATE_ROOM_CLOSED: whether the room was won
+    int score;                 // Points so far
+    int wins[ROLE_COUNT];      // Rooms won by each character, by enum CharacterRole
+    int runs[ROLE_COUNT];      // Rooms played by each character, by enum CharacterRole
+    int health;                // Enemy rooms: the monster's health
+    int attack;                // Enemy rooms, once closed: the Barbarian's attack
+    char barrier[SPELL_BUFFER_SIZE + 1]; // Barrier rooms: the encoded incantation, as Barrier.spell
+    char spell[SPELL_BUFFER_SIZE];   // Barrier rooms, once closed: the Wizard's answer
+    float trap;                // Trap rooms: the trap's angle
+    float pick;                // Trap rooms: the Rogue's last judged pick
+    char direction;            // Trap rooms: the last verdict ('u', 'd' or '-')
+    char treasure[4];          // Treasure revealed so far
+};
+
+struct SpectatorSlot {
+    unsigned long version;     // Odd while written, 2 * serial + 2 once complete
+    struct SpectatorSnapshot snapshot;
+} __attribute__((aligned(DUNGEON_CACHE_LINE)));
+
+struct SpectatorRing {
+    unsigned int layout;       // DUNGEON_SPECTATE_LAYOUT of the engine that created it
+    pid_t engine;              // PID of the engine publishing to it
+    unsigned long head __attribute__((aligned(DUNGEON_CACHE_LINE))); // Snapshots published
+    struct SpectatorSlot slots[SPECTATOR_RING_SLOTS];
+};
+
+// Identifies the ring layout a segment was created with.
+#define DUNGEON_SPECTATE_LAYOUT ((unsigned int)(sizeof(struct SpectatorSnapshot) | SPECTATOR_RING_SLOTS << 16))
+
+/*
+ * spectate_publish - Publishes a snapshot. Only the engine that owns the ring calls this.
+ * @snapshot: The state; its serial is filled in here.
+ */
+static inline void spectate_publish(struct SpectatorRing *ring, struct SpectatorSnapshot *snapshot) {
+    unsigned long serial = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+    struct SpectatorSlot *slot = &ring->slots[serial % SPECTATOR_RING_SLOTS];
+    snapshot->serial = serial;
+    __atomic_store_n(&slot->version, 2 * serial + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy(&slot->snapshot, snapshot, sizeof(*snapshot));
+    __atomic_store_n(&slot->version, 2 * serial + 2, __ATOMIC_RELEASE);
+    __atomic_store_n(&ring->head, serial + 1, __ATOMIC_RELEASE);
+}
+
+/*
+ * spectate_head - Returns how many snapshots have been published.
+ */
+static inline unsigned long spectate_head(const struct SpectatorRing *ring) {
+    return __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+}
+
+/*
+ * spectate_read - Copies snapshot @serial out of the ring.
+ * Returns 0 on success, 1 if it has not been published yet, and -1 if the writer has already
+ * overwritten it (the reader fell more than SPECTATOR_RING_SLOTS behind).
+ */
+static inline int spectate_read(const struct SpectatorRing *ring, unsigned long serial,
+                                struct SpectatorSnapshot *snapshot) {
+    const struct SpectatorSlot *slot = &ring->slots[serial % SPECTATOR_RING_SLOTS];
+    unsigned long wanted = 2 * serial + 2;
+    unsigned long before = __atomic_load_n(&slot->version, __ATOMIC_ACQUIRE);
+    if (before != wanted) {
+        return before > wanted ? -1 : 1;
+    }
+    memcpy(snapshot, &slot->snapshot, sizeof(*snapshot));
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    unsigned long after = __atomic_load_n(&slot->version, __ATOMIC_RELAXED);
+    return after == wanted ? 0 : -1;
+}
+
+#endif
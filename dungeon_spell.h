@@ -0,0 +1,53 @@
+/*
+ * dungeon_spell.h - Caesar cipher decoding for barrier spells.
+ * Shared by the wizard process and the multi-game character host.
+ */
+#ifndef DUNGEON_SPELL_H
+#define DUNGEON_SPELL_H
+
+#include <ctype.h>      // For isalpha, islower
+#include <stddef.h>     // For NULL
+
+/*
+ * decode_caesar_cipher - Decodes a Caesar cipher encoded string in a single pass.
+ * The first character is the key; the rest is the message. The input is read and the
+ * output written in the same loop, so no separate strlen, clear or copy pass is needed,
+ * and the output may be the final destination (e.g. dungeon_ptr->wizard.spell).
+ * @encoded: The null-terminated string to decode.
+ * @decoded: The buffer to store the decoded string.
+ * @max_len: The maximum size of the decoded buffer.
+ * Returns the length of the decoded string (excluding the terminator).
+ */
+static inline int decode_caesar_cipher(const char *encoded, char *decoded, int max_len) {
+    if (encoded == NULL || decoded == NULL || max_len <= 0) {
+        return 0; // Handle invalid input.
+    }
+
+    int key = encoded[0]; // The first character is the key.
+    if (key == '\0') {
+        decoded[0] = '\0'; // Empty encoded string results in empty decoded string.
+        return 0;
+    }
+    // Precompute the shift so each letter only needs one modulo.
+    int shift = 26 - key % 26;
+
+    // Iterate through the encoded string starting from the second character (index 1).
+    // The decoded index trails the encoded index by one, which also bounds the read.
+    int decoded_index = 0;
+    for (const char *p = encoded + 1; *p != '\0' && decoded_index < max_len - 1; ++p) {
+        unsigned char c = (unsigned char)*p;
+        if (isalpha(c)) {
+            char base = islower(c) ? 'a' : 'A';
+            // Apply the decoding shift; shift is always positive so the result is too.
+            decoded[decoded_index] = base + (c - base + shift) % 26;
+        } else {
+            // Copy non-alphabetical characters directly (including spaces and punctuation).
+            decoded[decoded_index] = c;
+        }
+        decoded_index++; // Move to the next position in the decoded buffer.
+    }
+    decoded[decoded_index] = '\0'; // Null-terminate the decoded string.
+    return decoded_index;
+}
+
+#endif
@@ -0,0 +1,378 @@
+/*
+ * dungeon_stats.c - Aggregates the columnar results log (./dungeon-stats).
+ * engine.c and master.c write one row per room to a results directory (see dungeon_results.h).
+ * This tool maps the columns of every chunk read-only and scans them as plain arrays:
+ *
+ *   - success rate and latency percentiles per kind of room,
+ *   - success rate and mean latency per barrier phrase (its index in the engine's list, or its
+ *     line's offset in the spell corpus), lowest success rate first. The phrases are tallied
+ *     in a hash table, so memory grows with the phrases played, not with the rows;
+ *   - success rate and mean latency per band of trap angles.
+ *
+ * Chunks are skipped without being scanned when their min/max stats rule them out for the
+ * -k and -g filters. The per-kind counts and sums are branch-free loops over the packed
+ * columns, which the compiler vectorizes at -O2 and above (`make release dungeon-stats`).
+ *
+ * Usage: ./dungeon-stats [-d dir] [-k enemy|barrier|trap] [-g game] [-n phrases]
+ */
+
+// Include necessary headers for system calls and standard libraries.
+#define _XOPEN_SOURCE 700       // Ensure POSIX features are available
+#define _POSIX_C_SOURCE 200809L // Ensure POSIX.1-2008 compliance
+
+#include <stdio.h>      // For printf, perror
+#include <stdlib.h>     // For exit, atoi, calloc, qsort
+#include <unistd.h>     // For close, getopt
+#include <sys/mman.h>   // For mmap, munmap
+#include <sys/stat.h>   // For fstat
+#include <fcntl.h>      // For open
+#include <dirent.h>     // For opendir, readdir
+#include <stdbool.h>    // For bool type
+#include <stdint.h>     // For int64_t, uint8_t
+#include <string.h>     // For memcmp, strlen, strcmp
+
+// Include custom header files for shared resources and settings.
+#include "dungeon_settings.h"  // Defines game parameters
+#include "dungeon_clock.h"     // Monotonic time, to report scan throughput
+#include "dungeon_slots.h"     // For enum RoomType
+#include "dungeon_histogram.h" // Latency percentiles
+#include "dungeon_results.h"   // Defines the column files
+
+// Width of the trap angle bands in the breakdown.
+#define ANGLE_BAND (10)
+
+// Rooms of one kind, phrase or angle band.
+struct Tally {
+    unsigned long rooms;
+    unsigned long won;
+    long long latency;         // Sum, in ns
+};
+
+// The barrier rooms of one phrase. A slot with no rooms is free.
+struct PhraseTally {
+    long long phrase;          // Index in the engine's list, or corpus offset | RESULTS_CORPUS_PHRASE
+    struct Tally tally;
+};
+
+// One column of a chunk, mapped.
+struct Column {
+    const struct ResultsColumnHeader *header;
+    const void *values;
+    size_t size;
+};
+
+// --- Global Variables ---
+const char *results_directory = NULL;  // The results directory
+int kind_filter = ROOM_NONE;           // Only rooms of this enum RoomType, ROOM_NONE for all
+bool game_filtered = false;            // Only rooms of game_filter
+long long game_filter = 0;
+struct Tally kinds[ROOM_TREASURE + 1]; // Indexed by enum RoomType
+struct LatencyHistogram latencies[ROOM_TREASURE + 1];
+struct PhraseTally *phrases = NULL;    // Open-addressing table, grown past 3/4 full
+size_t phrase_count = 0, phrase_capacity = 0; // The capacity is a power of two
+struct Tally angles[(MAX_PICK_ANGLE + ANGLE_BAND - 1) / ANGLE_BAND + 1]; // The last band catches anything beyond
+unsigned long chunks_scanned = 0, chunks_skipped = 0, rows_scanned = 0;
+
+// --- Function Definitions ---
+
+/*
+ * map_column - Maps one column file of a chunk and checks its header.
+ * @chunk: The chunk's file name prefix.
+ * @column: enum ResultsColumn.
+ * Returns true on success.
+ */
+static bool map_column(const char *chunk, int column, struct Column *out) {
+    char path[RESULTS_PATH_MAX + 96];
+    snprintf(path, sizeof(path), "%s/%s.%s.col", results_directory, chunk, results_column_name(column));
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) {
+        perror("DUNGEON-STATS: open failed");
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) == -1 || (size_t)info.st_size < sizeof(struct ResultsColumnHeader)) {
+        fprintf(stderr, "DUNGEON-STATS: %s is too short.\n", path);
+        close(fd);
+        return false;
+    }
+    void *memory = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd); // The mapping stays valid after the descriptor is closed.
+    if (memory == MAP_FAILED) {
+        perror("DUNGEON-STATS: mmap failed");
+        return false;
+    }
+    const struct ResultsColumnHeader *header = (const struct ResultsColumnHeader *)memory;
+    int type = results_column_type(column);
+    if (memcmp(header->magic, RESULTS_MAGIC, sizeof(RESULTS_MAGIC)) != 0 || header->type != (unsigned int)type ||
+        header->width != results_type_width(type) ||
+        sizeof(*header) + header->rows * header->width > (size_t)info.st_size) {
+        fprintf(stderr, "DUNGEON-STATS: %s is not a valid %s column.\n", path, results_column_name(column));
+        munmap(memory, (size_t)info.st_size);
+        return false;
+    }
+    out->header = header;
+    out->values = (const char *)memory + sizeof(*header);
+    out->size = (size_t)info.st_size;
+    return true;
+}
+
+/*
+ * tally_kind - Counts the rooms of one kind in a chunk that pass the filters.
+ * Branch-free, so the loop vectorizes.
+ * @mask: 1 for the rows the game filter lets through, or NULL when there is none.
+ */
+static void tally_kind(struct Tally *tally, int kind, const uint8_t *kind_of, const uint8_t *success,
+                       const int64_t *latency, const uint8_t *mask, unsigned long rows) {
+    unsigned long rooms = 0, won = 0;
+    long long sum = 0;
+    for (unsigned long i = 0; i < rows; i++) {
+        unsigned long match = (kind_of[i] == kind) & (mask == NULL || mask[i]);
+        rooms += match;
+        won += match & success[i];
+        sum += latency[i] & -(long long)match;
+    }
+    tally->rooms += rooms;
+    tally->won += won;
+    tally->latency += sum;
+}
+
+/*
+ * phrase_slot - Finds @phrase's slot in @table, or the free slot it would take.
+ * @capacity: The table's size, a power of two.
+ */
+static struct PhraseTally *phrase_slot(struct PhraseTally *table, size_t capacity, long long phrase) {
+    size_t slot = (size_t)(((uint64_t)phrase * 0x9E3779B97F4A7C15ULL) >> 32) & (capacity - 1);
+    while (table[slot].tally.rooms > 0 && table[slot].phrase != phrase) {
+        slot = (slot + 1) & (capacity - 1);
+    }
+    return &table[slot];
+}
+
+/*
+ * phrase_tally - Returns @phrase's tally, adding it to the table if it is new.
+ */
+static struct Tally *phrase_tally(long long phrase) {
+    if (4 * (phrase_count + 1) > 3 * phrase_capacity) {
+        size_t grown = phrase_capacity > 0 ? 2 * phrase_capacity : 256;
+        struct PhraseTally *table = calloc(grown, sizeof(*table));
+        if (table == NULL) {
+            perror("DUNGEON-STATS: calloc failed");
+            exit(EXIT_FAILURE);
+        }
+        for (size_t i = 0; i < phrase_capacity; i++) {
+            if (phrases[i].tally.rooms > 0) {
+                *phrase_slot(table, grown, phrases[i].phrase) = phrases[i];
+            }
+        }
+        free(phrases);
+        phrases = table;
+        phrase_capacity = grown;
+    }
+    struct PhraseTally *entry = phrase_slot(phrases, phrase_capacity, phrase);
+    if (entry->tally.rooms == 0) {
+        entry->phrase = phrase;
+        phrase_count++;
+    }
+    return &entry->tally;
+}
+
+/*
+ * scan_chunk - Aggregates one complete chunk, unless its min/max rule it out.
+ * @chunk: The chunk's file name prefix.
+ */
+static void scan_chunk(const char *chunk) {
+    struct Column columns[RESULTS_COLUMNS];
+    memset(columns, 0, sizeof(columns));
+    static const int needed[] = {RESULTS_KIND, RESULTS_GAME, RESULTS_PARAM, RESULTS_SUCCESS, RESULTS_LATENCY};
+    int mapped = 0;
+    for (; mapped < (int)(sizeof(needed) / sizeof(needed[0])); mapped++) {
+        if (!map_column(chunk, needed[mapped], &columns[needed[mapped]])) {
+            break;
+        }
+    }
+    bool complete = mapped == (int)(sizeof(needed) / sizeof(needed[0]));
+    unsigned long rows = complete ? columns[RESULTS_KIND].header->rows : 0;
+    for (int i = 0; complete && i < mapped; i++) {
+        complete = columns[needed[i]].header->rows == rows;
+    }
+    if (!complete) {
+        fprintf(stderr, "DUNGEON-STATS: skipping the incomplete chunk %s.\n", chunk);
+    } else if ((kind_filter != ROOM_NONE && (columns[RESULTS_KIND].header->min > kind_filter ||
+                                             columns[RESULTS_KIND].header->max < kind_filter)) ||
+               (game_filtered && (columns[RESULTS_GAME].header->min > (double)game_filter ||
+                                  columns[RESULTS_GAME].header->max < (double)game_filter))) {
+        chunks_skipped++;
+    } else {
+        const uint8_t *kind_of = columns[RESULTS_KIND].values;
+        const uint8_t *success = columns[RESULTS_SUCCESS].values;
+        const int64_t *latency = columns[RESULTS_LATENCY].values;
+        const int64_t *param = columns[RESULTS_PARAM].values;
+        const int64_t *game = columns[RESULTS_GAME].values;
+        uint8_t *mask = NULL;
+        if (game_filtered) {
+            mask = malloc(rows);
+            if (mask == NULL) {
+                perror("DUNGEON-STATS: malloc failed");
+                exit(EXIT_FAILURE);
+            }
+            for (unsigned long i = 0; i < rows; i++) {
+                mask[i] = game[i] == game_filter;
+            }
+        }
+        for (int kind = ROOM_ENEMY; kind <= ROOM_TRAP; kind++) {
+            if (kind_filter == ROOM_NONE || kind_filter == kind) {
+                tally_kind(&kinds[kind], kind, kind_of, success, latency, mask, rows);
+            }
+        }
+        // Percentiles and breakdowns need one bucket per row, so they take a second, scalar pass.
+        for (unsigned long i = 0; i < rows; i++) {
+            int kind = kind_of[i];
+            if (kind < ROOM_ENEMY || kind > ROOM_TRAP || (kind_filter != ROOM_NONE && kind != kind_filter) ||
+                (mask != NULL && !mask[i])) {
+                continue;
+            }
+            histogram_record(&latencies[kind], latency[i]);
+            struct Tally *tally = NULL;
+            if (kind == ROOM_BARRIER && param[i] >= 0) {
+                tally = phrase_tally(param[i]);
+            } else if (kind == ROOM_TRAP) {
+                long long band = param[i] / ANGLE_BAND;
+                long long last = (long long)(sizeof(angles) / sizeof(angles[0])) - 1;
+                tally = &angles[band < 0 ? 0 : band > last ? last : band];
+            }
+            if (tally != NULL) {
+                tally->rooms++;
+                tally->won += success[i];
+                tally->latency += latency[i];
+            }
+        }
+        free(mask);
+        chunks_scanned++;
+        rows_scanned += rows;
+    }
+    for (int i = 0; i < mapped; i++) {
+        munmap((void *)columns[needed[i]].header, columns[needed[i]].size);
+    }
+}
+
+/*
+ * print_tally - Prints one line of a breakdown.
+ */
+static void print_tally(const char *label, const struct Tally *tally) {
+    printf("[STATS]   %-18s %10lu rooms, %7.2f%% won, mean latency %.3f ms\n", label, tally->rooms,
+           100.0 * tally->won / tally->rooms, (double)tally->latency / tally->rooms / 1000000.0);
+}
+
+/*
+ * by_success - Orders phrases by success rate, lowest first, then by rooms played.
+ */
+static int by_success(const void *a, const void *b) {
+    const struct Tally *x = &((const struct PhraseTally *)a)->tally, *y = &((const struct PhraseTally *)b)->tally;
+    double rate_x = (double)x->won / x->rooms, rate_y = (double)y->won / y->rooms;
+    if (rate_x != rate_y) {
+        return rate_x < rate_y ? -1 : 1;
+    }
+    return x->rooms > y->rooms ? -1 : x->rooms < y->rooms;
+}
+
+/*
+ * main - Scans every chunk in the results directory and prints the aggregates.
+ */
+int main(int argc, char *argv[]) {
+    results_directory = results_dir();
+    int phrase_lines = 20;
+    int option;
+    while ((option = getopt(argc, argv, "d:k:g:n:")) != -1) {
+        switch (option) {
+        case 'd': results_directory = optarg; break;
+        case 'k':
+            kind_filter = strcmp(optarg, "enemy") == 0 ? ROOM_ENEMY : strcmp(optarg, "barrier") == 0 ? ROOM_BARRIER
+                        : strcmp(optarg, "trap") == 0 ? ROOM_TRAP : -1;
+            if (kind_filter < 0) {
+                fprintf(stderr, "DUNGEON-STATS: the kind must be enemy, barrier or trap.\n");
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'g': game_filtered = true; game_filter = strtoll(optarg, NULL, 0); break;
+        case 'n': phrase_lines = atoi(optarg); break;
+        default:
+            fprintf(stderr, "Usage: %s [-d dir] [-k enemy|barrier|trap] [-g game] [-n phrases]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (results_directory == NULL) {
+        fprintf(stderr, "DUNGEON-STATS: give the results directory with -d or DUNGEON_RESULTS.\n");
+        return EXIT_FAILURE;
+    }
+    DIR *dir = opendir(results_directory);
+    if (dir == NULL) {
+        perror("DUNGEON-STATS: opendir failed");
+        return EXIT_FAILURE;
+    }
+
+    // A chunk is complete once its kind column exists (see dungeon_results.h).
+    long long started = clock_now();
+    const char *suffix = ".kind.col";
+    size_t suffix_length = strlen(suffix);
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        size_t length = strlen(entry->d_name);
+        if (length > suffix_length && strcmp(entry->d_name + length - suffix_length, suffix) == 0) {
+            char chunk[256];
+            snprintf(chunk, sizeof(chunk), "%.*s", (int)(length - suffix_length), entry->d_name);
+            scan_chunk(chunk);
+        }
+    }
+    closedir(dir);
+    double elapsed = (double)(clock_now() - started) / NSEC_PER_SEC;
+
+    printf("[STATS] %lu rooms in %lu chunks (%lu more skipped by their min/max), scanned in %.3f s (%.1f M rooms/s).\n",
+           rows_scanned, chunks_scanned, chunks_skipped, elapsed, elapsed > 0 ? rows_scanned / elapsed / 1e6 : 0.0);
+    static const char *const kind_names[] = {"none", "enemy", "barrier", "trap", "treasure"};
+    for (int kind = ROOM_ENEMY; kind <= ROOM_TRAP; kind++) {
+        if (kinds[kind].rooms == 0) {
+            continue;
+        }
+        print_tally(kind_names[kind], &kinds[kind]);
+        char label[64];
+        snprintf(label, sizeof(label), "[STATS]     %s latency", kind_names[kind]);
+        histogram_print(label, &latencies[kind]);
+    }
+
+    // The table is not probed again, so its used slots are packed to the front and sorted in place.
+    size_t played = 0;
+    for (size_t i = 0; i < phrase_capacity; i++) {
+        if (phrases[i].tally.rooms > 0) {
+            phrases[played++] = phrases[i];
+        }
+    }
+    if (played > 0) {
+        qsort(phrases, played, sizeof(*phrases), by_success);
+        printf("[STATS] Barrier phrases, lowest success first (%zu played):\n", played);
+        for (size_t i = 0; i < played && i < (size_t)phrase_lines; i++) {
+            char label[40];
+            if (phrases[i].phrase & RESULTS_CORPUS_PHRASE) {
+                snprintf(label, sizeof(label), "corpus byte %lld", phrases[i].phrase & ~RESULTS_CORPUS_PHRASE);
+            } else {
+                snprintf(label, sizeof(label), "phrase %lld", phrases[i].phrase);
+            }
+            print_tally(label, &phrases[i].tally);
+        }
+    }
+    free(phrases);
+
+    bool any_angle = false;
+    for (size_t band = 0; band < sizeof(angles) / sizeof(angles[0]); band++) {
+        if (angles[band].rooms == 0) {
+            continue;
+        }
+        if (!any_angle) {
+            printf("[STATS] Trap angles:\n");
+            any_angle = true;
+        }
+        char label[32];
+        snprintf(label, sizeof(label), "%zu-%zu", band * ANGLE_BAND, band * ANGLE_BAND + ANGLE_BAND - 1);
+        print_tally(label, &angles[band]);
+    }
+    return EXIT_SUCCESS;
+}
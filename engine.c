@@ -0,0 +1,1136 @@
+/*
+ * engine.c - Reentrant dungeon engine (see engine.h).
+ * Plays the same game as dungeon.o: two enemy, barrier and trap rooms each, random rooms up
+ * to NUM_ROUNDS, then the treasure room, scored the same way. The difference is that all of
+ * a game's state lives in its struct DungeonEngine and all randomness comes from the engine's
+ * own generator, so nothing is shared between two engines running in one process.
+ */
+
+// Include necessary headers for system calls and standard libraries.
+#define _XOPEN_SOURCE 700       // Ensure POSIX features are available
+#define _POSIX_C_SOURCE 200809L // Ensure POSIX.1-2008 compliance
+#define _DEFAULT_SOURCE         // For syscall (futex, see dungeon_futex.h)
+#define DUNGEON_LIBRARY         // The program linking engine.o defines the resource names
+
+#include <stdio.h>      // For printf, puts
+#include <stdlib.h>     // For exit
+#include <string.h>     // For strcmp, strlen, memset, strchr
+#include <errno.h>      // For errno
+#include <fcntl.h>      // For O_* constants
+#include <signal.h>     // For kill, sigaction
+#include <sys/mman.h>   // For shm_open, mmap, munmap
+#include <sys/stat.h>   // For fstat
+#include <time.h>       // For clock_gettime, time
+#include <ctype.h>      // For isalnum
+
+#include "engine.h"
+#include "dungeon_settings.h"
+#include "dungeon_clock.h"
+#include "dungeon_futex.h"
+#include "dungeon_signals.h"
+#include "dungeon_spectate.h"
+#include "dungeon_corpus.h"
+
+// Phrases that may seal a barrier.
+static const char *const incantations[] = {
+    "Open sesame!",
+    "Speak friend and enter.",
+    "Boggle",
+    "Mother may I enter?",
+    "Simon says, open!",
+    "If you don't open this door right now, I swear...",
+    "Pizza's here!",
+    "Telegram!",
+    "I say unto thee... KNOCK!",
+    "42"
+};
+#define NUM_INCANTATIONS ((int)(sizeof(incantations) / sizeof(incantations[0])))
+
+// The spell corpus that replaces the phrases above when one is set. Mapped on the first barrier
+// drawn and shared by every engine in the process.
+static struct SpellCorpus corpus;
+static pthread_once_t corpus_once = PTHREAD_ONCE_INIT;
+
+// Characters that may be used as the Caesar key of a barrier.
+static const char valid_chars[] = "abcdefghijlmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+// Words the treasure may be made of.
+static const char *const treasures[] = { "swim", "mill", "fish", "pell", "llet" };
+#define NUM_TREASURES ((int)(sizeof(treasures) / sizeof(treasures[0])))
+
+// Punctuation _SafePrint lets through when echoing a character's answer.
+static const char acceptable_punctuation[] = "!,-.?'";
+
+// Arguments of a lever check thread.
+struct LeverCheck {
+    sem_t *lever;
+    bool *clear;
+};
+
+// --- Random Numbers ---
+
+static inline uint32_t rotl32(uint32_t x, int k) {
+    return (x << k) | (x >> (32 - k));
+}
+
+/*
+ * engine_random - Returns the next 32 random bits of an engine's xoshiro128** generator.
+ */
+uint32_t engine_random(struct DungeonEngine *engine) {
+    uint32_t *s = engine->random.s;
+    uint32_t result = rotl32(s[1] * 5, 7) * 9;
+    uint32_t t = s[1] << 9;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl32(s[3], 11);
+    return result;
+}
+
+/*
+ * random_below - Returns a random number in [0, bound), like rand() % bound.
+ */
+static uint32_t random_below(struct DungeonEngine *engine, uint32_t bound) {
+    return (uint32_t)(((uint64_t)engine_random(engine) * bound) >> 32);
+}
+
+/*
+ * splitmix64 - Expands a seed into well-mixed 64-bit words for the generator state.
+ */
+static uint64_t splitmix64(uint64_t *state) {
+    uint64_t z = (*state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+// --- Helpers ---
+
+/*
+ * safe_print - Prints a character's answer, skipping anything that is not printable text.
+ */
+static void safe_print(const char *text) {
+    for (size_t i = 0; i < SPELL_BUFFER_SIZE && text[i] != '\0'; i++) {
+        unsigned char c = (unsigned char)text[i];
+        if (isalnum(c) || c == ' ' || strchr(acceptable_punctuation, c) != NULL) {
+            putchar(c);
+        }
+    }
+    putchar('\n');
+}
+
+/*
+ * encode - Caesar-encodes a phrase with the given key, as _Encode in dungeon.o.
+ * @out: Receives the encoded phrase, null-terminated.
+ * @size: Bytes @out holds; at most @size - 1 characters are encoded.
+ * @in: The phrase.
+ * @key: The key; letters are shifted forward by key % 26.
+ */
+static void encode(char *out, size_t size, const char *in, int key) {
+    size_t length = strlen(in);
+    size_t i;
+    for (i = 0; i < length && i + 1 < size; i++) {
+        char c = in[i];
+        if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')) {
+            char base = (c >= 'a') ? 'a' : 'A';
+            out[i] = base + (c - base + key) % 26;
+        } else {
+            out[i] = c;
+        }
+    }
+    out[i] = '\0';
+}
+
+/*
+ * character_alive - Returns true if a character process still exists.
+ */
+static bool character_alive(pid_t pid) {
+    return pid > 0 && kill(pid, 0) == 0;
+}
+
+/*
+ * lever_check - Thread that takes a lever as soon as nobody holds it.
+ * Taking it means the character that held it has let go.
+ * @arg: Pointer to a struct LeverCheck.
+ */
+static void *lever_check(void *arg) {
+    struct LeverCheck *check = (struct LeverCheck *)arg;
+    if (sem_wait(check->lever) == 0) {
+        __atomic_store_n(check->clear, true, __ATOMIC_RELEASE);
+    }
+    return NULL;
+}
+
+/*
+ * open_room - Announces a new room before its character is signalled.
+ * Publishes when the room closes and what kind of room it is, bumps roomSeq, which the
+ * character echoes into answerSeq once its answer is written, and wakes characters waiting
+ * on roomSeq (see character.h). Also counts the time since the previous room closed.
+ * @budget_ns: How long the room stays open.
+ * @type: The room's enum RoomType.
+ * Returns the room's sequence number.
+ */
+static unsigned int open_room(struct DungeonEngine *engine, long long budget_ns, int type) {
+    struct Dungeon *dungeon = engine->dungeon;
+    long long now = clock_now();
+    if (engine->closedAt > 0 && type != ROOM_TREASURE) {
+        engine->roomGapTime += now - engine->closedAt;
+        engine->roomGaps++;
+    }
+    if (engine->spectators != NULL) {
+        engine->view.roomType = type;
+        engine->view.room++;
+    }
+    engine->openedAt = now;
+    __atomic_store_n(&dungeon->roomDeadline, now + budget_ns, __ATOMIC_RELAXED);
+    __atomic_store_n(&dungeon->roomType, type, __ATOMIC_RELAXED);
+    unsigned int seq = __atomic_add_fetch(&dungeon->roomSeq, 1, __ATOMIC_RELEASE);
+    futex_wake(&dungeon->roomSeq);
+    return seq;
+}
+
+/*
+ * signal_room - Tells a character about a room.
+ * Sends the queued realtime signal with the room in its payload when engine->signalPayloads
+ * is set, or the plain signal dungeon.o would send otherwise, and bumps the character's
+ * eventfd when game.c set one up.
+ * @pid: The character.
+ * @signum: DUNGEON_SIGNAL or SEMAPHORE_SIGNAL.
+ * @seq: The room's sequence number.
+ * @type: The room's enum RoomType.
+ * Returns 0 on success, -1 if the character could not be signaled.
+ */
+static int signal_room(struct DungeonEngine *engine, pid_t pid, int signum, unsigned int seq, int type) {
+    int role = pid == engine->wizard ? ROLE_WIZARD : pid == engine->barbarian ? ROLE_BARBARIAN : ROLE_ROGUE;
+    int event_fd = engine->dungeon->eventFds[role];
+    if (event_fd > 0) {
+        uint64_t one = 1;
+        if (write(event_fd, &one, sizeof(one)) == -1) {
+            fprintf(stderr, "Could not notify a character's eventfd. Errno: %d\n", errno);
+        }
+    }
+    if (!engine->signalPayloads) {
+        return kill(pid, signum);
+    }
+    int realtime = signum == SEMAPHORE_SIGNAL ? SEMAPHORE_RT_SIGNAL : DUNGEON_RT_SIGNAL;
+    return sigqueue(pid, realtime, room_signal_encode(seq, type, engine->slot));
+}
+
+/*
+ * await_answer - Waits until the character has answered room seq or the room closes.
+ * dungeon.o always sleeps out the whole room; here the room ends as soon as the answer
+ * is in, and characters that never set answerSeq simply get the full time as before.
+ * @seq: Sequence number returned by open_room.
+ * @kind: ROLE_WIZARD or ROLE_BARBARIAN, whose answer time is recorded.
+ */
+static void await_answer(struct DungeonEngine *engine, unsigned int seq, int kind) {
+    struct Dungeon *dungeon = engine->dungeon;
+    long long opened = clock_now();
+    long long closes = __atomic_load_n(&dungeon->roomDeadline, __ATOMIC_RELAXED);
+    while (__atomic_load_n(&dungeon->answerSeq, __ATOMIC_ACQUIRE) != seq && clock_now() < closes) {
+        clock_sleep(ENGINE_ANSWER_POLL * NSEC_PER_USEC);
+    }
+    if (__atomic_load_n(&dungeon->answerSeq, __ATOMIC_ACQUIRE) == seq) {
+        engine->roomsAnswered[kind]++;
+        engine->answerTime[kind] += clock_now() - opened;
+    }
+}
+
+// --- Spectators ---
+
+/*
+ * spectate_open - Creates the engine's spectator ring, replacing one left by an earlier game.
+ * Spectating is optional: on failure the game goes on without it.
+ */
+static void spectate_open(struct DungeonEngine *engine) {
+    memset(&engine->view, 0, sizeof(engine->view));
+    engine->spectators = NULL;
+    if (!engine->spectate || engine->spectateName == NULL) {
+        return;
+    }
+    // Leave the ring alone if another live engine is publishing to it; otherwise it is stale.
+    int old = shm_open(engine->spectateName, O_RDONLY, 0);
+    if (old != -1) {
+        struct stat info;
+        pid_t owner = 0;
+        if (fstat(old, &info) == 0 && (size_t)info.st_size >= sizeof(struct SpectatorRing)) {
+            void *memory = mmap(NULL, sizeof(struct SpectatorRing), PROT_READ, MAP_SHARED, old, 0);
+            if (memory != MAP_FAILED) {
+                owner = ((const struct SpectatorRing *)memory)->engine;
+                munmap(memory, sizeof(struct SpectatorRing));
+            }
+        }
+        close(old);
+        if (owner > 0 && owner != getpid() && kill(owner, 0) == 0) {
+            fprintf(stderr, "Engine %d is already publishing to %s, playing without spectators.\n", owner, engine->spectateName);
+            return;
+        }
+    }
+    shm_unlink(engine->spectateName);
+    int fd = shm_open(engine->spectateName, O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd == -1 || ftruncate(fd, sizeof(struct SpectatorRing)) == -1) {
+        fprintf(stderr, "Could not create the spectator ring, playing without it. Errno: %d\n", errno);
+        if (fd != -1) {
+            close(fd);
+            shm_unlink(engine->spectateName);
+        }
+        return;
+    }
+    void *memory = mmap(NULL, sizeof(struct SpectatorRing), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED) {
+        fprintf(stderr, "Could not map the spectator ring, playing without it. Errno: %d\n", errno);
+        shm_unlink(engine->spectateName);
+        return;
+    }
+    engine->spectators = (struct SpectatorRing *)memory;
+    engine->spectators->engine = getpid();
+    __atomic_store_n(&engine->spectators->layout, DUNGEON_SPECTATE_LAYOUT, __ATOMIC_RELEASE);
+}
+
+/*
+ * spectate - Publishes the engine's view of the game as a snapshot of @event.
+ */
+static void spectate(struct DungeonEngine *engine, int event) {
+    if (engine->spectators == NULL) {
+        return;
+    }
+    struct SpectatorSnapshot *view = &engine->view;
+    view->time = clock_now();
+    view->event = event;
+    view->score = engine->score;
+    memcpy(view->wins, engine->wins, sizeof(view->wins));
+    memcpy(view->runs, engine->runs, sizeof(view->runs));
+    spectate_publish(engine->spectators, view);
+}
+
+/*
+ * spectate_room - Publishes a room as it opens or closes, from the engine's own copy of it.
+ * @event: SPECTATE_ROOM_OPENED or SPECTATE_ROOM_CLOSED.
+ */
+static void spectate_room(struct DungeonEngine *engine, const struct EngineRoom *room, int event) {
+    struct SpectatorSnapshot *view = &engine->view;
+    if (engine->spectators == NULL) {
+        return;
+    }
+    bool closed = event == SPECTATE_ROOM_CLOSED;
+    view->passed = closed && room->passed;
+    if (room->kind == ROLE_BARBARIAN) {
+        view->health = room->health;
+        view->attack = closed ? room->attack : 0;
+    } else if (room->kind == ROLE_WIZARD) {
+        memcpy(view->barrier, room->spell, sizeof(view->barrier));
+        if (closed) {
+            memcpy(view->spell, room->given, SPELL_BUFFER_SIZE);
+        } else {
+            view->spell[0] = '\0';
+        }
+    } else {
+        view->trap = room->trap;
+        if (!closed) {
+            view->direction = 'w';
+        }
+    }
+    spectate(engine, event);
+}
+
+/*
+ * spectate_close - Publishes the end of the game and removes the ring.
+ * Spectators that have it mapped keep reading it.
+ */
+static void spectate_close(struct DungeonEngine *engine) {
+    if (engine->spectators == NULL) {
+        return;
+    }
+    engine->view.roomType = ROOM_NONE;
+    spectate(engine, SPECTATE_GAME_OVER);
+    munmap(engine->spectators, sizeof(struct SpectatorRing));
+    engine->spectators = NULL;
+    shm_unlink(engine->spectateName);
+}
+
+/*
+ * levers_downed - Returns true while both levers are held.
+ */
+static bool levers_downed(struct DungeonEngine *engine) {
+    int first = 1, second = 1;
+    sem_getvalue(engine->firstLever, &first);
+    sem_getvalue(engine->secondLever, &second);
+    return first == 0 && second == 0;
+}
+
+// --- Rooms ---
+
+/*
+ * stage_room - Decides the game's next room and draws everything it needs.
+ * Guaranteed rooms come first (MIN_BARBARIAN_RUNS, MIN_WIZARD_RUNS, MIN_ROGUE_RUNS), then
+ * random rooms up to NUM_ROUNDS, in the same order and with the same draws as dungeon.o.
+ * @room: The buffer to stage it in.
+ * Returns false once the game has no rooms left.
+ */
+static bool stage_room(struct DungeonEngine *engine, struct EngineRoom *room) {
+    int barbarian = ALLOW_BARBARIAN ? MIN_BARBARIAN_RUNS : 0;
+    int wizard = ALLOW_WIZARD ? MIN_WIZARD_RUNS : 0;
+    int rogue = ALLOW_ROGUE ? MIN_ROGUE_RUNS : 0;
+    int allowed[ROLE_COUNT];
+    int count = 0;
+    if (ALLOW_WIZARD) allowed[count++] = ROLE_WIZARD;
+    if (ALLOW_BARBARIAN) allowed[count++] = ROLE_BARBARIAN;
+    if (ALLOW_ROGUE) allowed[count++] = ROLE_ROGUE;
+
+    int index = engine->roomsStaged;
+    room->round = -1;
+    if (index < barbarian) {
+        room->kind = ROLE_BARBARIAN;
+    } else if (index < barbarian + wizard) {
+        room->kind = ROLE_WIZARD;
+    } else if (index < barbarian + wizard + rogue) {
+        room->kind = ROLE_ROGUE;
+    } else if (index < NUM_ROUNDS && count > 0) {
+        room->round = index;
+        room->kind = allowed[random_below(engine, count)];
+    } else {
+        return false;
+    }
+    engine->roomsStaged++;
+    room->closed = false;
+    if (room->kind == ROLE_BARBARIAN) {
+        room->health = (int)(engine_random(engine) >> 1);
+    } else if (room->kind == ROLE_WIZARD) {
+        engine_draw_barrier(engine, room->spell);
+        memcpy(room->answer, engine->barrierAnswer, SPELL_BUFFER_SIZE);
+        room->phrase = engine->barrierPhrase;
+    } else {
+        room->trap = engine_draw_trap(engine);
+    }
+    return true;
+}
+
+static void report_room(struct EngineRoom *room);
+
+/*
+ * overlap_room - Work done while the characters answer the live room, when pipelining.
+ * Reports the room before it and stages the next one in the other buffer. Called by each
+ * room once it is announced, or as it gives up when its character is gone.
+ */
+static void overlap_room(struct DungeonEngine *engine) {
+    struct EngineRoom *other = &engine->rooms[(engine->roomEpoch + 1) & 1];
+    if (!engine->pipelineRooms || engine->nextStaged) {
+        return;
+    }
+    if (other->closed) {
+        report_room(other);
+    }
+    engine->nextStaged = stage_room(engine, other);
+}
+
+/*
+ * do_enemy - Sends the Barbarian against the staged monster.
+ * Returns true if the Barbarian matched the monster's health in time.
+ */
+static bool do_enemy(struct DungeonEngine *engine, struct EngineRoom *room) {
+    struct Dungeon *dungeon = engine->dungeon;
+    if (!character_alive(engine->barbarian)) {
+        puts("The Barbarian process is no longer running. (Did it crash?)");
+        puts("You might need to revise how you set up signals.");
+        return false;
+    }
+    puts("This room has a monster in it!");
+    dungeon->enemy.health = room->health;
+    unsigned int seq = open_room(engine, SECONDS_TO_ATTACK * NSEC_PER_SEC, ROOM_ENEMY);
+    signal_room(engine, engine->barbarian, DUNGEON_SIGNAL, seq, ROOM_ENEMY);
+    spectate_room(engine, room, SPECTATE_ROOM_OPENED);
+    overlap_room(engine);
+    await_answer(engine, seq, ROLE_BARBARIAN);
+    room->latency = clock_now() - engine->openedAt;
+    room->attack = dungeon->barbarian.attack;
+    return room->attack == room->health;
+}
+
+/*
+ * do_barrier - Seals the staged barrier for the Wizard.
+ * Returns true if the Wizard's spell matches the incantation in time.
+ */
+static bool do_barrier(struct DungeonEngine *engine, struct EngineRoom *room) {
+    struct Dungeon *dungeon = engine->dungeon;
+    if (!character_alive(engine->wizard)) {
+        puts("The Wizard process is no longer running. (Did it crash?)");
+        puts("You might need to revise how you set up signals, or your method of decoding the barrier.");
+        return false;
+    }
+    puts("A barrier impedes your progress!");
+    memcpy(dungeon->barrier.spell, room->spell, sizeof(dungeon->barrier.spell));
+    dungeon->wizard.spell[0] = '\0';
+    __atomic_store_n(&dungeon->spellLength, 0, __ATOMIC_RELAXED);
+    printf("The barrier is blocked by an ancient incantation: %s\n", room->spell);
+    unsigned int seq = open_room(engine, SECONDS_TO_GUESS_BARRIER * NSEC_PER_SEC, ROOM_BARRIER);
+    signal_room(engine, engine->wizard, DUNGEON_SIGNAL, seq, ROOM_BARRIER);
+    spectate_room(engine, room, SPECTATE_ROOM_OPENED);
+    overlap_room(engine);
+    await_answer(engine, seq, ROLE_WIZARD);
+    room->latency = clock_now() - engine->openedAt;
+    // The wizard publishes the length after the spell, so compare by length and memcmp like master.c.
+    int length = __atomic_load_n(&dungeon->spellLength, __ATOMIC_ACQUIRE);
+    memcpy(room->given, dungeon->wizard.spell, SPELL_BUFFER_SIZE);
+    room->given[SPELL_BUFFER_SIZE - 1] = '\0';
+    return length > 0 && (size_t)length == strlen(room->answer) && memcmp(room->given, room->answer, length) == 0;
+}
+
+/*
+ * adapt_tick - Measures how fast the Rogue answered a judgement and retunes the tick.
+ * The rogue stamps pickTime when it publishes a pick, so the time from the first judgement of
+ * its previous pick to that stamp is its response latency. The tick follows
+ * ENGINE_TICK_FACTOR times the running average of that latency, clamped to
+ * [ENGINE_TICK_MIN, ENGINE_TICK_MAX]. A rogue that never stamps its picks leaves the tick at
+ * TIME_BETWEEN_ROGUE_TICKS.
+ */
+static void adapt_tick(struct DungeonEngine *engine, long long now) {
+    long long published = __atomic_load_n(&engine->dungeon->pickTime, __ATOMIC_RELAXED);
+    if (published == engine->judgedPick) {
+        return; // Same pick as last time: the rogue has not answered yet.
+    }
+    if (ENGINE_ADAPTIVE_TICK && engine->judgedAt > 0 && published > engine->judgedAt) {
+        long long sample = published - engine->judgedAt;
+        // Running average with weight 1/8, seeded by the first sample.
+        engine->pickLatency = engine->pickLatency == 0 ? sample : engine->pickLatency + (sample - engine->pickLatency) / 8;
+        long long tick = (long long)(ENGINE_TICK_FACTOR * engine->pickLatency);
+        if (tick < ENGINE_TICK_MIN * NSEC_PER_USEC) tick = ENGINE_TICK_MIN * NSEC_PER_USEC;
+        if (tick > ENGINE_TICK_MAX * NSEC_PER_USEC) tick = ENGINE_TICK_MAX * NSEC_PER_USEC;
+        engine->tickInterval = tick;
+    }
+    engine->judgedPick = published;
+    engine->judgedAt = now;
+}
+
+/*
+ * judge_pick - Compares the Rogue's current pick with the trap and answers it.
+ * Sets the direction to 'u' or 'd', or unlocks the trap with '-' when the pick is within
+ * LOCK_THRESHOLD. The answer is written with a compare-and-swap against the direction read
+ * together with the pick, so a verdict on a pick the rogue has just replaced (direction now
+ * 't') is dropped instead of being taken as feedback on the new one.
+ * Returns true if the trap unlocked.
+ */
+static bool judge_pick(struct DungeonEngine *engine) {
+    struct Dungeon *dungeon = engine->dungeon;
+    unsigned int picks = __atomic_load_n(&dungeon->pickSeq, __ATOMIC_ACQUIRE);
+    char seen = __atomic_load_n(&dungeon->trap.direction, __ATOMIC_ACQUIRE);
+    float pick = dungeon->rogue.pick;
+    printf("The rogue's pick is at position %f -> %f, %c\n", pick, engine->trapValue, seen);
+    char verdict = '-';
+    if (pick < engine->trapValue - LOCK_THRESHOLD) {
+        verdict = 'u';
+    } else if (pick > engine->trapValue + LOCK_THRESHOLD) {
+        verdict = 'd';
+    }
+    if (!__atomic_compare_exchange_n(&dungeon->trap.direction, &seen, verdict, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        return false; // A new pick landed meanwhile; it is judged next.
+    }
+    engine->picksJudged++;
+    engine->judgedValue = pick;
+    adapt_tick(engine, clock_now());
+    if (engine->spectators != NULL) {
+        engine->view.pick = pick;
+        engine->view.direction = verdict;
+        spectate(engine, SPECTATE_PICK_JUDGED);
+    }
+    if (verdict == '-') {
+        engine->unlockSeq = picks; // Read before the unlock, so the rogue's park cannot come earlier.
+        dungeon->trap.locked = false;
+        return true;
+    }
+    return false;
+}
+
+/*
+ * await_park - Waits until the Rogue has parked its pick after an unlock, or @end passes.
+ * The rogue bumps pickSeq once it has seen the unlock and parked its pick for the next trap,
+ * so a trap that follows at once is not locked while it is still searching this one.
+ */
+static void await_park(struct DungeonEngine *engine, long long end) {
+    struct Dungeon *dungeon = engine->dungeon;
+    unsigned int seen = engine->unlockSeq;
+    while (__atomic_load_n(&dungeon->pickSeq, __ATOMIC_ACQUIRE) == seen) {
+        long long left = end - clock_now();
+        if (left <= 0) {
+            return;
+        }
+        futex_wait(&dungeon->pickSeq, seen, left);
+    }
+}
+
+/*
+ * await_picks - Judges every pick the Rogue publishes until the trap unlocks or @end passes.
+ * Sleeps on pickSeq, which the rogue bumps and wakes after each pick, so a pick is judged as
+ * soon as it is written. A rogue that never bumps pickSeq is still judged once every
+ * tick, whenever its direction shows a new pick ('t').
+ * Returns true if the trap unlocked.
+ */
+static bool await_picks(struct DungeonEngine *engine, long long end) {
+    struct Dungeon *dungeon = engine->dungeon;
+    unsigned int seen = __atomic_load_n(&dungeon->pickSeq, __ATOMIC_ACQUIRE);
+    // The pick in place when the trap locked is judged straight away.
+    if (judge_pick(engine)) {
+        return true;
+    }
+    for (;;) {
+        long long left = end - clock_now();
+        if (left <= 0) {
+            return false;
+        }
+        long long tick = engine->tickInterval;
+        futex_wait(&dungeon->pickSeq, seen, left < tick ? left : tick);
+        unsigned int current = __atomic_load_n(&dungeon->pickSeq, __ATOMIC_ACQUIRE);
+        if (current != seen || dungeon->trap.direction == 't') {
+            seen = current;
+            if (judge_pick(engine)) {
+                return true;
+            }
+        }
+    }
+}
+
+/*
+ * do_trap - Locks the staged trap and judges the Rogue's picks until it unlocks or SECONDS_TO_PICK pass.
+ * Picks are judged as they are published when engine->trapEvents is set, or once per
+ * engine->tickInterval (see adapt_tick) otherwise. After an unlock it only waits for the
+ * rogue to park its pick (see await_park), so the next room opens right away.
+ * Returns true if the pick came within LOCK_THRESHOLD of the trap in time.
+ */
+static bool do_trap(struct DungeonEngine *engine, struct EngineRoom *room) {
+    struct Dungeon *dungeon = engine->dungeon;
+    if (!character_alive(engine->rogue)) {
+        puts("The Rogue process is no longer running. (Did it crash?)");
+        puts("You might need to revise how you set up signals.");
+        return false;
+    }
+    puts("This room is guarded by a trap!");
+    dungeon->trap.direction = 'w';
+    dungeon->trap.locked = true;
+    unsigned int seq = open_room(engine, SECONDS_TO_PICK * NSEC_PER_SEC, ROOM_TRAP);
+    signal_room(engine, engine->rogue, DUNGEON_SIGNAL, seq, ROOM_TRAP);
+
+    long long start = clock_now();
+    long long end = start + SECONDS_TO_PICK * NSEC_PER_SEC;
+    engine->trapValue = room->trap;
+    float initial_pick = dungeon->rogue.pick;
+    // Latency is only measured between judgements of this trap.
+    engine->judgedPick = -1;
+    engine->judgedAt = 0;
+    spectate_room(engine, room, SPECTATE_ROOM_OPENED);
+    overlap_room(engine);
+
+    bool unlocked = false;
+    if (engine->trapEvents) {
+        unlocked = await_picks(engine, end);
+    } else {
+        while (!unlocked && clock_now() < end) {
+            unlocked = judge_pick(engine);
+            if (!unlocked) {
+                clock_sleep(engine->tickInterval);
+            }
+        }
+    }
+    long long spent = clock_now() - start;
+    engine->trapTime += spent;
+    // The rogue parks its pick for the next trap as soon as this one unlocks, so keep the pick that won.
+    room->pick = unlocked ? engine->judgedValue : dungeon->rogue.pick;
+    room->latency = clock_now() - engine->openedAt;
+    if (unlocked) {
+        engine->trapsUnlocked++;
+        engine->unlockTime += spent;
+        printf("Trap unlocked in %.3f ms with a %.3f ms tick.\n", spent / 1000000.0, engine->tickInterval / 1000000.0);
+        // A rogue that never reports its park costs at most one tick here.
+        await_park(engine, clock_now() + engine->tickInterval);
+        return true;
+    }
+    putchar('\n');
+
+    // Time is up: release the rogue from its search.
+    for (int i = 0; i < 10; i++) {
+        dungeon->trap.direction = '-';
+        dungeon->trap.locked = false;
+        clock_sleep(100 * NSEC_PER_USEC);
+    }
+    if (dungeon->rogue.pick == initial_pick) {
+        puts("The rogue didn't move their pick much. Ensure you don't have another rogue process running.");
+        puts("Also check to make sure that your rogue is able to register when the dungeon has returned success.");
+    }
+    return false;
+}
+
+/*
+ * record_room - Appends a closed room to the results log, if one is open.
+ */
+static void record_room(struct DungeonEngine *engine, const struct EngineRoom *room) {
+    struct ResultsRow row;
+    memset(&row, 0, sizeof(row));
+    row.game = engine->gameId;
+    row.round = (int)engine->roomEpoch;
+    row.success = room->passed;
+    row.latency = room->latency;
+    if (room->kind == ROLE_BARBARIAN) {
+        row.kind = ROOM_ENEMY;
+        row.param = room->health;
+        row.answer = room->attack;
+    } else if (room->kind == ROLE_WIZARD) {
+        row.kind = ROOM_BARRIER;
+        row.param = room->phrase;
+        row.key = (unsigned char)room->spell[0];
+        row.answer = (double)strnlen(room->given, SPELL_BUFFER_SIZE);
+    } else {
+        row.kind = ROOM_TRAP;
+        row.param = (long long)room->trap;
+        row.answer = room->pick;
+    }
+    results_append(&engine->results, &row);
+}
+
+/*
+ * play_room - Plays the live room and keeps its outcome in @room for report_room.
+ * The room's data was staged beforehand, so it opens as soon as the previous one closed.
+ */
+static void play_room(struct DungeonEngine *engine, struct EngineRoom *room) {
+    struct Dungeon *dungeon = engine->dungeon;
+    int kind = room->kind;
+    if (room->round >= 0) {
+        printf("Enter for loop, %d\n", room->round);
+    }
+    engine->runs[kind]++;
+    room->attack = dungeon->barbarian.attack;
+    room->given[0] = '\0';
+    room->pick = dungeon->rogue.pick;
+    room->latency = 0;
+    room->passed = (kind == ROLE_BARBARIAN) ? do_enemy(engine, room)
+                 : (kind == ROLE_WIZARD) ? do_barrier(engine, room)
+                 : do_trap(engine, room);
+    engine->closedAt = clock_now();
+    overlap_room(engine); // In case the room never opened.
+    room->closed = true;
+    if (room->passed) {
+        engine->score++;
+        engine->wins[kind]++;
+    }
+    spectate_room(engine, room, SPECTATE_ROOM_CLOSED);
+    record_room(engine, room);
+}
+
+/*
+ * report_room - Prints the outcome of a room that has closed, as dungeon.o does.
+ */
+static void report_room(struct EngineRoom *room) {
+    bool passed = room->passed;
+    room->closed = false;
+    puts(passed ? "\033[0;32mSUCCESS\033[0;39m" : "\033[0;31mFAILURE\033[0;39m");
+    if (room->kind == ROLE_BARBARIAN) {
+        printf(passed ? "The barbarian successfully incapacitated the monster!\n"
+                      : "The barbarian failed to incapacitate the monster.\n");
+        printf("Monster: %d\nBarbarian: %d\n", room->health, room->attack);
+    } else if (room->kind == ROLE_WIZARD) {
+        if (passed) {
+            printf("The wizard successfully brought down the magical barrier!\nThe magical phrase was: \"%s\"\n",
+                   room->given);
+        } else {
+            puts("The wizard failed to successfully bring down the magical barrier!");
+            printf("Answer the wizard gave:\t");
+            safe_print(room->given);
+            printf("Encoded phrase: \t%s\n", room->spell);
+            printf("Answer to riddle: \t%s\n", room->answer);
+        }
+    } else {
+        printf(passed ? "The rogue successfully disarmed the trap!\n" : "The rogue failed to disarm the trap.\n");
+        printf("Trap: %f\nRogue pick: %f\n", room->trap, room->pick);
+    }
+}
+
+/*
+ * do_treasure - Plays the treasure room and adds its points to the score.
+ * The levers are drained and posted once, the Barbarian and Wizard are told to hold them,
+ * the treasure is revealed one character per second for the Rogue, and the holders must
+ * let go before TIME_TREASURE_AVAILABLE runs out.
+ */
+static void do_treasure(struct DungeonEngine *engine) {
+    struct Dungeon *dungeon = engine->dungeon;
+
+    engine->firstLever = sem_open(engine->leverOneName, O_RDWR);
+    engine->secondLever = sem_open(engine->leverTwoName, O_RDWR);
+    int value = 0;
+    if (engine->firstLever == SEM_FAILED || sem_getvalue(engine->firstLever, &value) != 0) {
+        printf("First semaphore not currently set up properly, exitting. ERRNO: %d\n", errno);
+        dungeon->running = false;
+        return;
+    }
+    for (; value > 0; sem_getvalue(engine->firstLever, &value)) {
+        sem_wait(engine->firstLever);
+    }
+    if (engine->secondLever == SEM_FAILED || sem_getvalue(engine->secondLever, &value) != 0) {
+        printf("Second semaphore not currently set up properly, exitting. ERRNO: %d\n", errno);
+        dungeon->running = false;
+        return;
+    }
+    for (; value > 0; sem_getvalue(engine->secondLever, &value)) {
+        sem_wait(engine->secondLever);
+    }
+    memset(dungeon->treasure, 0, sizeof(dungeon->treasure));
+    memset(dungeon->spoils, 0, sizeof(dungeon->spoils));
+    sem_post(engine->firstLever);
+    sem_post(engine->secondLever);
+
+    puts("\033[0;33mBehold, the door to the treasure has opened!\033[0;39m");
+    unsigned int seq = open_room(engine, TIME_TREASURE_AVAILABLE * NSEC_PER_SEC, ROOM_TREASURE);
+    int party = 3;
+    if (signal_room(engine, engine->wizard, SEMAPHORE_SIGNAL, seq, ROOM_TREASURE) != 0) {
+        puts("\033[0;31mThe Wizard did not survive the dungeon (the process crashed before we could send the next signal.)\033[0;39m");
+        party--;
+    }
+    if (signal_room(engine, engine->barbarian, SEMAPHORE_SIGNAL, seq, ROOM_TREASURE) != 0) {
+        puts("\033[0;31mThe Barbarian did not survive the dungeon (the process crashed before we could send the next signal.)\033[0;39m");
+        party--;
+    }
+    if (signal_room(engine, engine->rogue, SEMAPHORE_SIGNAL, seq, ROOM_TREASURE) != 0) {
+        puts("\033[0;31mThe Rogue did not survive the dungeon (the process crashed before we could send the next signal.)\033[0;39m");
+        party--;
+    }
+    if (party < 3) {
+        puts("\033[0;31mInsufficient party members to continue quest. Need at least three to obtain treasure.\033[0;39m");
+        dungeon->running = false;
+        return;
+    }
+    // Give the Barbarian and Wizard up to two seconds to take the levers, but no longer than they need.
+    long long grab_by = clock_now() + 2 * NSEC_PER_SEC;
+    while (!levers_downed(engine) && clock_now() < grab_by) {
+        clock_sleep(ENGINE_ANSWER_POLL * NSEC_PER_USEC);
+    }
+
+    // The check threads take each lever as soon as its holder lets go.
+    engine->firstSemClear = false;
+    engine->secondSemClear = false;
+    struct LeverCheck first = { engine->firstLever, &engine->firstSemClear };
+    struct LeverCheck second = { engine->secondLever, &engine->secondSemClear };
+    pthread_t first_thread, second_thread;
+    int error = pthread_create(&first_thread, NULL, lever_check, &first);
+    if (error != 0) {
+        printf("Failed to initialize first sem thread. Error code: %d\n", error);
+        dungeon->running = false;
+        return;
+    }
+    error = pthread_create(&second_thread, NULL, lever_check, &second);
+    if (error != 0) {
+        printf("Failed to initialize second sem thread. Error code: %d\n", error);
+        pthread_cancel(first_thread);
+        pthread_join(first_thread, NULL);
+        dungeon->running = false;
+        return;
+    }
+    clock_sleep(ENGINE_ANSWER_POLL * NSEC_PER_USEC); // Let a thread take a lever nobody holds.
+    bool downed = true;
+    if (__atomic_load_n(&engine->firstSemClear, __ATOMIC_ACQUIRE)) {
+        puts("First lever semaphore was not downed.");
+        downed = false;
+    }
+    if (__atomic_load_n(&engine->secondSemClear, __ATOMIC_ACQUIRE)) {
+        puts("Second lever semaphore was not downed.");
+        downed = false;
+    }
+
+    int treasure_points = 0;
+    if (!downed) {
+        puts("Semaphores not downed properly, or not downed in time.");
+    } else {
+        // Reveal the treasure one character at a time. The next one slides out as soon as the
+        // Rogue has copied the last, or after a second if it has not.
+        const char *treasure = treasures[random_below(engine, NUM_TREASURES)];
+        for (int i = 0; i < 4; i++) {
+            dungeon->treasure[i] = treasure[i];
+            if (engine->spectators != NULL) {
+                engine->view.treasure[i] = treasure[i];
+                spectate(engine, SPECTATE_TREASURE);
+            }
+            long long next_at = clock_now() + NSEC_PER_SEC;
+            while (dungeon->spoils[i] != treasure[i] && clock_now() < next_at) {
+                clock_sleep(ENGINE_ANSWER_POLL * NSEC_PER_USEC);
+            }
+        }
+        printf("\033[0;32mCurrent total score: %d/%d\n\033[0;39m", engine->score, 40);
+        printf("The treasure obtained by the Rogue was: %.4s\n", dungeon->spoils);
+        for (int i = 0; i < 4; i++) {
+            if (dungeon->spoils[i] == treasure[i]) {
+                treasure_points += POINTS_PER_TREASURE_CHAR;
+            }
+        }
+        engine->score += treasure_points;
+
+        // The holders must let go before the door closes.
+        long long closes = clock_now() + (TIME_TREASURE_AVAILABLE - 4) * NSEC_PER_SEC;
+        while (clock_now() < closes && !(__atomic_load_n(&engine->firstSemClear, __ATOMIC_ACQUIRE) &&
+                                         __atomic_load_n(&engine->secondSemClear, __ATOMIC_ACQUIRE))) {
+            clock_sleep(ENGINE_ANSWER_POLL * NSEC_PER_USEC);
+        }
+    }
+
+    bool closed = __atomic_load_n(&engine->firstSemClear, __ATOMIC_ACQUIRE) &&
+                  __atomic_load_n(&engine->secondSemClear, __ATOMIC_ACQUIRE);
+    pthread_cancel(first_thread);
+    pthread_cancel(second_thread);
+    pthread_join(first_thread, NULL);
+    pthread_join(second_thread, NULL);
+    if (downed && closed) {
+        engine->score += POINTS_FOR_POSTING_SEMAPHORES;
+        puts("\033[0;32mSuccessfully closed door behind Rogue in time.\033[0;39m");
+        printf("\033[0;32mTotal score: %d/%d\n\033[0;39m", engine->score,
+               40 + 4 * POINTS_PER_TREASURE_CHAR + POINTS_FOR_POSTING_SEMAPHORES);
+    } else if (downed) {
+        puts("The Rogue curses as the door slams shut suddenly, locking the Rogue inside. The semaphores were downed, but never posted.");
+        printf("\033[0;32mTotal score minus a Rogue: %d/%d\n\033[0;39m", engine->score,
+               40 + 4 * POINTS_PER_TREASURE_CHAR + POINTS_FOR_POSTING_SEMAPHORES);
+    }
+    dungeon->running = false;
+}
+
+// --- Public Interface ---
+
+/*
+ * engine_init - See engine.h.
+ */
+void engine_init(struct DungeonEngine *engine, pid_t wizard, pid_t rogue, pid_t barbarian, uint64_t seed) {
+    memset(engine, 0, sizeof(*engine));
+    engine->shmName = dungeon_shm_name;
+    engine->leverOneName = dungeon_lever_one;
+    engine->leverTwoName = dungeon_lever_two;
+    engine->spectateName = NULL;
+    engine->wizard = wizard;
+    engine->rogue = rogue;
+    engine->barbarian = barbarian;
+    engine->dungeon = MAP_FAILED;
+    engine->firstLever = SEM_FAILED;
+    engine->secondLever = SEM_FAILED;
+    engine->trapEvents = ENGINE_TRAP_EVENTS;
+    engine->signalPayloads = DUNGEON_SIGNAL_PAYLOADS;
+    engine->tickInterval = TIME_BETWEEN_ROGUE_TICKS * NSEC_PER_USEC;
+    engine->pipelineRooms = ENGINE_PIPELINE_ROOMS;
+    engine->gameId = (long long)seed;
+    for (int i = 0; i < 4; i += 2) {
+        uint64_t word = splitmix64(&seed);
+        engine->random.s[i] = (uint32_t)word;
+        engine->random.s[i + 1] = (uint32_t)(word >> 32);
+    }
+}
+
+/*
+ * load_corpus - Maps the spell corpus, if one is set. Runs once per process.
+ */
+static void load_corpus(void) {
+    const char *path = corpus_path();
+    if (path == NULL) {
+        return;
+    }
+    if (corpus_open(&corpus, path) == 0) {
+        printf("Drawing barrier phrases from %s (%.1f MiB).\n", path, corpus.size / 1048576.0);
+    } else {
+        fprintf(stderr, "Could not map the spell corpus, using the built-in phrases.\n");
+    }
+}
+
+/*
+ * engine_draw_barrier - See engine.h.
+ */
+void engine_draw_barrier(struct DungeonEngine *engine, char *spell) {
+    char key = valid_chars[random_below(engine, sizeof(valid_chars) - 1)];
+    pthread_once(&corpus_once, load_corpus);
+    engine->barrierPhrase = -1;
+    if (corpus.text != NULL) {
+        uint64_t random = (uint64_t)engine_random(engine) << 32;
+        random |= engine_random(engine);
+        long long offset = corpus_draw(&corpus, random, engine->barrierAnswer);
+        engine->barrierPhrase = offset < 0 ? -1 : offset | RESULTS_CORPUS_PHRASE;
+    }
+    if (engine->barrierPhrase < 0) {
+        engine->barrierPhrase = random_below(engine, NUM_INCANTATIONS);
+        strncpy(engine->barrierAnswer, incantations[engine->barrierPhrase], SPELL_BUFFER_SIZE - 1);
+        engine->barrierAnswer[SPELL_BUFFER_SIZE - 1] = '\0';
+    }
+
+    spell[0] = key;
+    encode(spell + 1, SPELL_BUFFER_SIZE, engine->barrierAnswer, key);
+}
+
+/*
+ * engine_draw_trap - See engine.h.
+ */
+float engine_draw_trap(struct DungeonEngine *engine) {
+    return (float)random_below(engine, MAX_PICK_ANGLE);
+}
+
+/*
+ * engine_run - See engine.h.
+ */
+int engine_run(struct DungeonEngine *engine) {
+    puts("Verifying PID's...");
+    if (!character_alive(engine->wizard)) {
+        puts("Wizard is not running, or PID is wrong.");
+        return -1;
+    }
+    if (!character_alive(engine->rogue)) {
+        puts("Rogue is not running, or PID is wrong.");
+        return -1;
+    }
+    if (!character_alive(engine->barbarian)) {
+        puts("Barbarian is not running, or PID is wrong.");
+        return -1;
+    }
+    if (engine->wizard == engine->barbarian || engine->wizard == engine->rogue || engine->barbarian == engine->rogue) {
+        puts("Duplicate PID passed, not valid.");
+        return -1;
+    }
+    // Scored like dungeon.o: 5 for valid PIDs, 10 for the shared memory, 1 per room won,
+    // then 10 for running to the end and 5 more if no character crashed on the way.
+    engine->score = 5;
+    puts("All pid's valid. Attempting to open shared memory...:");
+
+    int fd = shm_open(engine->shmName, O_RDWR, 0666);
+    if (fd == -1) {
+        fprintf(stderr, "There was an error opening shared memory in our dungeon library. Errno: %d. Terminating...\n", errno);
+        return -1;
+    }
+    engine->dungeon = mmap(NULL, sizeof(struct Dungeon), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (engine->dungeon == MAP_FAILED) {
+        fprintf(stderr, "Library error mapping shared memory. Errno: %d\n", errno);
+        return -1;
+    }
+    struct Dungeon *dungeon = engine->dungeon;
+    engine->score += 10;
+    dungeon->dungeonPID = getpid();
+    memset(dungeon->treasure, 0, sizeof(dungeon->treasure));
+    memset(dungeon->spoils, 0, sizeof(dungeon->spoils));
+    dungeon->running = true;
+    spectate_open(engine);
+    spectate(engine, SPECTATE_GAME_STARTED);
+    const char *results = results_dir();
+    if (results != NULL && results_open(&engine->results, results) == -1) {
+        fprintf(stderr, "Could not open the results log in %s, playing without it.\n", results);
+    }
+
+    // Every character gets its guaranteed rooms first, then random rooms fill up NUM_ROUNDS (see
+    // stage_room). Each room is played from rooms[roomEpoch & 1] while the other buffer is
+    // reported and restaged (see overlap_room), then the epoch flips.
+    long long started = clock_now();
+    engine->roomEpoch = 0;
+    engine->roomsStaged = 0;
+    engine->closedAt = 0;
+    engine->nextStaged = stage_room(engine, &engine->rooms[0]);
+    while (engine->nextStaged) {
+        struct EngineRoom *room = &engine->rooms[engine->roomEpoch & 1];
+        engine->nextStaged = false;
+        play_room(engine, room);
+        if (!engine->pipelineRooms) {
+            report_room(room);
+            engine->nextStaged = stage_room(engine, &engine->rooms[(engine->roomEpoch + 1) & 1]);
+        }
+        engine->roomEpoch++;
+    }
+    struct EngineRoom *last = &engine->rooms[(engine->roomEpoch + 1) & 1];
+    if (last->closed) {
+        report_room(last);
+    }
+    int rounds = (int)engine->roomEpoch;
+
+    double elapsed = (double)(clock_now() - started) / NSEC_PER_SEC;
+    printf("Played %d rooms in %.2f s (%.2f rooms/s).\n", rounds, elapsed, elapsed > 0 ? rounds / elapsed : 0.0);
+    if (engine->roomGaps > 0) {
+        printf("Rooms opened %.1f us after the previous one closed on average (%s).\n",
+               (double)engine->roomGapTime / engine->roomGaps / 1000.0, engine->pipelineRooms ? "pipelined" : "serial");
+    }
+    static const char *const answered_by[ROLE_COUNT] = {
+        [ROLE_WIZARD] = "Wizard", [ROLE_BARBARIAN] = "Barbarian", [ROLE_ROGUE] = "Rogue"};
+    for (int kind = 0; kind < ROLE_COUNT; kind++) {
+        if (engine->roomsAnswered[kind] > 0) {
+            printf("%s answered %d rooms in %.3f ms on average.\n", answered_by[kind], engine->roomsAnswered[kind],
+                   (double)engine->answerTime[kind] / engine->roomsAnswered[kind] / 1000000.0);
+        }
+    }
+    if (engine->picksJudged > 0) {
+        double trap_seconds = (double)engine->trapTime / NSEC_PER_SEC;
+        printf("Trap (%s): %lu picks judged in %.3f s (%.0f picks/s)", engine->trapEvents ? "events" : "ticks",
+               engine->picksJudged, trap_seconds, trap_seconds > 0 ? engine->picksJudged / trap_seconds : 0.0);
+        if (engine->trapsUnlocked > 0) {
+            printf(", %.3f ms mean time to unlock", (double)engine->unlockTime / engine->trapsUnlocked / 1000000.0);
+        }
+        puts(".");
+        printf("Rogue tick: %.3f ms (rogue answers in %.3f ms on average).\n", engine->tickInterval / 1000000.0,
+               engine->pickLatency / 1000000.0);
+    }
+    engine->score += 10;
+    printf("+%d points for successfully compiling and running\n", 10);
+    if (character_alive(engine->wizard) && character_alive(engine->barbarian) && character_alive(engine->rogue)) {
+        engine->score += 5;
+        printf("+%d points for not crashing\n", 5);
+    }
+    printf("Wizard:    %d/%d\n", engine->wins[ROLE_WIZARD], engine->runs[ROLE_WIZARD]);
+    printf("Barbarian: %d/%d\n", engine->wins[ROLE_BARBARIAN], engine->runs[ROLE_BARBARIAN]);
+    printf("Rogue:     %d/%d\n", engine->wins[ROLE_ROGUE], engine->runs[ROLE_ROGUE]);
+    printf("\033[0;32mScore before semaphores: %d/%d\n\033[0;39m", engine->score, 40);
+
+    do_treasure(engine);
+    spectate_close(engine);
+    if (results_close(&engine->results) == -1) {
+        fprintf(stderr, "Could not write the last rooms to the results log.\n");
+    }
+
+    if (engine->firstLever != SEM_FAILED) {
+        sem_close(engine->firstLever);
+        engine->firstLever = SEM_FAILED;
+    }
+    if (engine->secondLever != SEM_FAILED) {
+        sem_close(engine->secondLever);
+        engine->secondLever = SEM_FAILED;
+    }
+    munmap(engine->dungeon, sizeof(struct Dungeon));
+    engine->dungeon = MAP_FAILED;
+    return engine->score;
+}
+
+// --- dungeon.o Compatibility ---
+
+// The engine RunDungeon is playing, so SIGINT can be passed on to its characters.
+static struct DungeonEngine *interrupted_engine = NULL;
+
+/*
+ * forward_sigint - Passes SIGINT on to the characters, as dungeon.o does.
+ */
+static void forward_sigint(int signum) {
+    struct DungeonEngine *engine = interrupted_engine;
+    if (engine != NULL) {
+        kill(engine->wizard, signum);
+        kill(engine->rogue, signum);
+        kill(engine->barbarian, signum);
+    }
+}
+
+/*
+ * RunDungeon - Drop-in replacement for dungeon.o's entry point.
+ * Plays one game on /DungeonMem, seeded from the time and PID like dungeon.o, and publishes it
+ * to /DungeonSpectate for spectator.c. Only this wrapper installs a process-wide SIGINT
+ * handler; engine_run itself installs none.
+ */
+void RunDungeon(pid_t wizard, pid_t rogue, pid_t barbarian) {
+    struct DungeonEngine engine;
+    engine_init(&engine, wizard, rogue, barbarian, (uint64_t)time(NULL) + (uint64_t)getpid());
+    engine.spectateName = DUNGEON_SPECTATE_SHM_NAME;
+    engine.spectate = ENGINE_SPECTATE;
+
+    interrupted_engine = &engine;
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = forward_sigint;
+    if (sigaction(SIGINT, &sa, NULL) == -1) {
+        fprintf(stderr, "Library error setting up signal interrupt. Errno: %d\n", errno);
+    }
+
+    if (engine_run(&engine) < 0) {
+        interrupted_engine = NULL;
+        exit(EXIT_FAILURE);
+    }
+    interrupted_engine = NULL;
+}
@@ -0,0 +1,168 @@
+/*
+ * engine.h - Reentrant dungeon engine.
+ * An open replacement for dungeon.o. Everything one game needs (the shared memory it maps,
+ * the character PIDs, the trap and barrier answers, the lever semaphores, the score and the
+ * random generator) lives in a struct DungeonEngine instead of in globals, and random numbers
+ * come from a per-engine xoshiro128** generator instead of rand(). Several engines can
+ * therefore run at once on separate threads of one process, as long as each is given its own
+ * shared memory and lever names.
+ *
+ * Traps are judged as soon as the rogue publishes a pick (it bumps Dungeon.pickSeq and wakes
+ * the engine with a futex) unless trapEvents is cleared after engine_init, in which case the
+ * engine polls once per tick like dungeon.o. The tick starts at TIME_BETWEEN_ROGUE_TICKS and
+ * follows how quickly this game's rogue answers (ENGINE_ADAPTIVE_TICK).
+ *
+ * Rooms are double-buffered: the engine keeps two struct EngineRoom and flips between them
+ * with roomEpoch. While the characters answer the live room, the engine reports the room before
+ * it from the other buffer and stages the next one there (its kind, monster, barrier or
+ * trap), so the next room can be announced as soon as this one closes. Clearing pipelineRooms
+ * after engine_init reports and stages between rooms instead, like dungeon.o.
+ *
+ * Spectators never read the game's shared memory. An engine with spectate set publishes a
+ * snapshot to its spectator ring (spectateName, see dungeon_spectate.h) at every change of
+ * state instead. engine_init leaves it off; RunDungeon turns it on for /DungeonSpectate.
+ * Engines that run at once need distinct spectateNames, as they need distinct shmNames: an
+ * engine will not take over a ring another live engine is publishing to.
+ *
+ * When a results directory is set (see dungeon_results.h), every room the engine closes is
+ * appended to its columnar results log, under gameId.
+ *
+ * engine.o also provides RunDungeon, so `make DUNGEON_OBJ=engine.o` builds game against it.
+ */
+#ifndef DUNGEON_ENGINE_H
+#define DUNGEON_ENGINE_H
+
+#include <pthread.h>    // For pthread_t
+#include <semaphore.h>  // For sem_t
+#include <stdbool.h>    // For bool type
+#include <stdint.h>     // For uint32_t, uint64_t
+#include <unistd.h>     // For pid_t
+
+#include "dungeon_info.h"
+#include "dungeon_spectate.h"
+#include "dungeon_results.h"
+
+// State of a xoshiro128** generator. Never all zero once seeded.
+struct EngineRandom {
+    uint32_t s[4];
+};
+
+// One room of a game: staged before it opens, then kept with its outcome until it is reported.
+struct EngineRoom {
+    int kind;                            // enum CharacterRole of the character that plays it
+    int round;                           // Round number of a random room, -1 for a guaranteed one
+    int health;                          // Enemy rooms: the monster's health
+    char spell[SPELL_BUFFER_SIZE + 1];   // Barrier rooms: the encoded incantation, key first, as Barrier.spell
+    char answer[SPELL_BUFFER_SIZE];      // Barrier rooms: the incantation
+    long long phrase;                    // Barrier rooms: barrierPhrase when the room was drawn
+    float trap;                          // Trap rooms: the trap's angle
+    bool closed;                         // Played and not yet reported; the fields below are set
+    bool passed;
+    int attack;                          // The Barbarian's attack when the room closed
+    char given[SPELL_BUFFER_SIZE];       // The Wizard's spell when the room closed
+    float pick;                          // The Rogue's pick when the room closed
+    long long latency;                   // Nanoseconds from opening to the answer or the close
+};
+
+struct DungeonEngine {
+    // Names of the resources shared with this game's characters.
+    const char *shmName;
+    const char *leverOneName;
+    const char *leverTwoName;
+    const char *spectateName;  // NULL until set; distinct for every engine running at once
+
+    pid_t wizard;
+    pid_t rogue;
+    pid_t barbarian;
+
+    struct Dungeon *dungeon;   // Mapping of shmName, set up by engine_run
+    struct EngineRandom random;
+
+    float trapValue;                     // Angle of the current trap
+    char barrierAnswer[SPELL_BUFFER_SIZE]; // Decoded phrase of the current barrier
+    long long barrierPhrase;               // Index of that phrase, or its corpus offset | RESULTS_CORPUS_PHRASE
+
+    sem_t *firstLever;
+    sem_t *secondLever;
+    bool firstSemClear;        // Set by the lever check thread once it could take Lever One
+    bool secondSemClear;       // Set by the lever check thread once it could take Lever Two
+
+    int score;                 // Points so far
+    int wins[ROLE_COUNT];      // Rooms passed, by enum CharacterRole
+    int runs[ROLE_COUNT];      // Rooms played, by enum CharacterRole
+
+    bool signalPayloads;       // Signal rooms with queued realtime signals (see dungeon_signals.h)
+    int slot;                  // Slot index sent in realtime signal payloads, 0 for a standalone game
+
+    int roomsAnswered[ROLE_COUNT]; // Rooms answered through answerSeq, by enum CharacterRole
+    long long answerTime[ROLE_COUNT]; // Nanoseconds from signaling to answer, over those rooms
+
+    bool trapEvents;           // Judge each pick when published (true) or once per tick (false)
+    unsigned long picksJudged; // Rogue picks judged over all traps
+    long long trapTime;        // Nanoseconds spent in trap rooms
+    long long unlockTime;      // Nanoseconds from locking to unlocking, over unlocked traps
+    int trapsUnlocked;         // Traps the rogue unlocked
+
+    long long tickInterval;    // Nanoseconds between trap checks, tuned per game by the rogue's latency
+    long long pickLatency;     // Running average of the rogue's response time in nanoseconds, 0 until measured
+    long long judgedPick;      // Dungeon.pickTime of the pick judged last
+    long long judgedAt;        // clock_now() of the first judgement of that pick
+    float judgedValue;         // Dungeon.rogue.pick as judged last; the winning pick once a trap unlocks
+    unsigned int unlockSeq;    // Dungeon.pickSeq when the last trap unlocked, before the rogue parked its pick
+
+    struct EngineRoom rooms[2]; // The live room is rooms[roomEpoch & 1], the other is staged or awaits its report
+    unsigned int roomEpoch;    // Rooms played so far; flips the buffers
+    int roomsStaged;           // Rooms staged so far, which decides the next room's kind
+    bool nextStaged;           // The other buffer holds the next room
+    bool pipelineRooms;        // Report and stage while the live room is answered (true) or between rooms (false)
+    long long openedAt;        // clock_now() when the last room opened
+    long long closedAt;        // clock_now() when the last room closed, 0 before the first
+    long long roomGapTime;     // Nanoseconds from one room closing to the next opening, over roomGaps
+    int roomGaps;
+
+    bool spectate;             // Publish snapshots to spectateName
+    struct SpectatorRing *spectators; // Mapping of spectateName, NULL when not publishing
+    struct SpectatorSnapshot view; // The state published next, only kept while spectators is set
+
+    long long gameId;          // Identifies the game in the results log; the seed given to engine_init
+    struct ResultsWriter results; // Columnar results log, open while a game runs with a results directory
+};
+
+/*
+ * engine_init - Prepares an engine for one game with the default /DungeonMem resources.
+ * @engine: The engine to initialize.
+ * @wizard, @rogue, @barbarian: PIDs of the character processes.
+ * @seed: Seed for the engine's random generator.
+ */
+void engine_init(struct DungeonEngine *engine, pid_t wizard, pid_t rogue, pid_t barbarian, uint64_t seed);
+
+/*
+ * engine_run - Plays one full game with the characters given to engine_init.
+ * Opens the engine's shared memory (created by the caller) and its levers, runs every room
+ * and the treasure room, and prints the score.
+ * Returns the score, or -1 if the game could not be started.
+ */
+int engine_run(struct DungeonEngine *engine);
+
+/*
+ * engine_draw_barrier - Draws the next barrier the way a game does.
+ * Stores the phrase in engine->barrierAnswer and writes the encoded spell (key first) to @spell,
+ * which must hold SPELL_BUFFER_SIZE + 1 bytes like Barrier.spell: the key, up to
+ * SPELL_BUFFER_SIZE - 1 characters of phrase and the terminator. With a spell corpus set (see
+ * dungeon_corpus.h) the phrase comes from the corpus, which is mapped on the first call.
+ */
+void engine_draw_barrier(struct DungeonEngine *engine, char *spell);
+
+/*
+ * engine_draw_trap - Draws the angle of the next trap the way a game does.
+ * With the same seed, the same sequence of draws gives the same barriers and traps, which is
+ * how plugin_ab plays two strategies against one scenario.
+ */
+float engine_draw_trap(struct DungeonEngine *engine);
+
+/*
+ * engine_random - Returns the next 32 random bits of an engine's generator.
+ */
+uint32_t engine_random(struct DungeonEngine *engine);
+
+#endif
@@ -0,0 +1,306 @@
+/*
+ * exporter.c - Exports the counters of /DungeonSlots for the Prometheus node exporter.
+ * The master and the hosts only bump counters in the segment with relaxed atomics
+ * (slots->stats and slots->host, see dungeon_slots.h). This process maps the segment
+ * read-only, and every interval formats a snapshot in the Prometheus text format into a
+ * file for node_exporter's textfile collector, e.g.
+ *
+ *   ./exporter -o /var/lib/node_exporter/textfile/dungeon.prom
+ *
+ * The file is written under a temporary name and renamed into place, so the collector never
+ * reads half a file. Until a segment exists only dungeon_up 0 is written. Once the master has
+ * finished and removed its segment, the exporter keeps the mapping and goes on exporting the
+ * final counters, until a new master creates a new segment, which it then maps instead.
+ *
+ * Usage: ./exporter [-o file] [-i interval_ms] [-1]
+ */
+
+// Include necessary headers for system calls and standard libraries.
+#define _XOPEN_SOURCE 700       // Ensure POSIX features are available
+#define _POSIX_C_SOURCE 200809L // Ensure POSIX.1-2008 compliance
+
+#include <stdio.h>      // For printf, perror, fopen, rename
+#include <stdlib.h>     // For exit, atoi
+#include <unistd.h>     // For close, getpid, getopt, fsync
+#include <sys/mman.h>   // For shared memory functions (shm_open, mmap, munmap)
+#include <sys/stat.h>   // For fstat
+#include <fcntl.h>      // For file control options
+#include <signal.h>     // For sigaction
+#include <stdbool.h>    // For bool type
+#include <string.h>     // For memset
+
+// Include custom header files for shared resources and settings.
+#include "dungeon_info.h"      // Defines the Dungeon struct layout
+#include "dungeon_settings.h"  // Defines game parameters
+#include "dungeon_slots.h"     // Defines the multi-game slot layout and its counters
+#include "dungeon_clock.h"     // Monotonic time
+#include "dungeon_histogram.h" // Bucket limits of the latency histogram
+
+// Upper bounds (in seconds) of the exported latency buckets; +Inf is added after them.
+static const double latency_bounds[] = {
+    0.00001, 0.000025, 0.00005, 0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005,
+    0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1.0, 2.5, 5.0, 10.0
+};
+
+// --- Global Variables ---
+const struct DungeonSlots *slots = NULL; // The mapped segment, NULL while none exists
+size_t slots_size = 0;                   // Size of the mapping
+ino_t slots_inode = 0;                   // Identifies the segment that is mapped
+
+// Flag to control the exporter's exit, set by the SIGINT handler.
+volatile sig_atomic_t exit_flag = 0;
+
+// --- Function Definitions ---
+
+/*
+ * sigint_handler - Handles SIGINT (Ctrl+C) and SIGTERM for graceful exit.
+ * @signum: The signal number.
+ */
+void sigint_handler(int signum) {
+    (void)signum;
+    exit_flag = 1;
+}
+
+/*
+ * counter - Reads a counter another process is updating.
+ */
+static inline unsigned long counter(const unsigned long *value) {
+    return __atomic_load_n(value, __ATOMIC_RELAXED);
+}
+
+/*
+ * detach - Unmaps the segment, if one is mapped.
+ */
+static void detach(void) {
+    if (slots != NULL) {
+        munmap((void *)slots, slots_size);
+        slots = NULL;
+        slots_inode = 0;
+    }
+}
+
+/*
+ * attach - Makes sure the current /DungeonSlots is the one mapped.
+ * Remaps when the master has replaced the segment, and keeps the old mapping when the
+ * segment has been removed.
+ * Returns true if a segment is mapped.
+ */
+static bool attach(void) {
+    int fd = shm_open(DUNGEON_SLOTS_SHM_NAME, O_RDONLY, 0);
+    if (fd == -1) {
+        return slots != NULL;
+    }
+    struct stat info;
+    if (fstat(fd, &info) == -1) {
+        perror("EXPORTER: fstat failed");
+        close(fd);
+        detach();
+        return false;
+    }
+    if (slots != NULL && info.st_ino == slots_inode && (size_t)info.st_size == slots_size) {
+        close(fd);
+        return true;
+    }
+    detach();
+    if ((size_t)info.st_size < sizeof(struct DungeonSlots)) {
+        close(fd); // The master has not sized it yet.
+        return false;
+    }
+    void *memory = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd); // The mapping stays valid after the descriptor is closed.
+    if (memory == MAP_FAILED) {
+        perror("EXPORTER: mmap failed");
+        return false;
+    }
+    slots = (const struct DungeonSlots *)memory;
+    slots_size = (size_t)info.st_size;
+    slots_inode = info.st_ino;
+    if (slots->layout != DUNGEON_SLOTS_LAYOUT) {
+        fprintf(stderr, "EXPORTER: /DungeonSlots uses another slot layout; rebuild master and exporter alike.\n");
+        detach();
+        return false;
+    }
+    printf("[EXPORTER] Attached to /DungeonSlots with %d slots.\n", slots->count);
+    return true;
+}
+
+/*
+ * metric_header - Writes the HELP and TYPE lines of a metric.
+ */
+static void metric_header(FILE *out, const char *name, const char *type, const char *help) {
+    fprintf(out, "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+/*
+ * write_latency - Writes a latency histogram as a Prometheus histogram in seconds.
+ * Takes one snapshot of the buckets first, so the cumulative counts never decrease and
+ * _count matches the +Inf bucket. Bucket edges are rounded down to the histogram's own
+ * resolution (12.5%): a bucket is counted under a bound once all of it lies below.
+ * @out: The file being written.
+ * @name: The metric name.
+ * @help: The HELP text.
+ * @histogram: The shared histogram.
+ */
+static void write_latency(FILE *out, const char *name, const char *help, const struct LatencyHistogram *histogram) {
+    unsigned long counts[HISTOGRAM_BUCKETS];
+    for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        counts[i] = counter(&histogram->counts[i]);
+    }
+    long long sum = __atomic_load_n(&histogram->sum, __ATOMIC_RELAXED);
+
+    metric_header(out, name, "histogram", help);
+    unsigned long cumulative = 0;
+    int bucket = 0;
+    for (size_t b = 0; b < sizeof(latency_bounds) / sizeof(latency_bounds[0]); b++) {
+        long long bound = (long long)(latency_bounds[b] * NSEC_PER_SEC);
+        for (; bucket < HISTOGRAM_BUCKETS && histogram_bucket_limit(bucket) <= bound; bucket++) {
+            cumulative += counts[bucket];
+        }
+        fprintf(out, "%s_bucket{le=\"%g\"} %lu\n", name, latency_bounds[b], cumulative);
+    }
+    for (; bucket < HISTOGRAM_BUCKETS; bucket++) {
+        cumulative += counts[bucket];
+    }
+    fprintf(out, "%s_bucket{le=\"+Inf\"} %lu\n", name, cumulative);
+    fprintf(out, "%s_sum %.9f\n", name, (double)sum / NSEC_PER_SEC);
+    fprintf(out, "%s_count %lu\n", name, cumulative);
+}
+
+/*
+ * write_metrics - Writes a snapshot of every counter in the Prometheus text format.
+ * @out: The file being written.
+ */
+static void write_metrics(FILE *out) {
+    metric_header(out, "dungeon_up", "gauge", "Whether the exporter has a /DungeonSlots segment mapped.");
+    fprintf(out, "dungeon_up %d\n", slots != NULL);
+    if (slots == NULL) {
+        return;
+    }
+    const struct SchedulerStats *stats = &slots->stats;
+    const struct HostStats *host = &slots->host;
+
+    metric_header(out, "dungeon_running", "gauge", "Whether the master is still playing games.");
+    fprintf(out, "dungeon_running %d\n", __atomic_load_n(&slots->running, __ATOMIC_RELAXED) ? 1 : 0);
+    metric_header(out, "dungeon_slots", "gauge", "Games the segment can hold at once.");
+    fprintf(out, "dungeon_slots %d\n", slots->count);
+
+    metric_header(out, "dungeon_rooms_opened_total", "counter", "Rooms the master opened.");
+    fprintf(out, "dungeon_rooms_opened_total %lu\n", counter(&stats->roomsOpened));
+    metric_header(out, "dungeon_rooms_closed_total", "counter", "Rooms the master closed, by result.");
+    fprintf(out, "dungeon_rooms_closed_total{result=\"passed\"} %lu\n", counter(&stats->roomsPassed));
+    fprintf(out, "dungeon_rooms_closed_total{result=\"failed\"} %lu\n", counter(&stats->roomsFailed));
+    metric_header(out, "dungeon_missed_deadlines_total", "counter", "Scheduler jobs the master ran late, by job.");
+    fprintf(out, "dungeon_missed_deadlines_total{job=\"dispatch\"} %lu\n", counter(&stats->missedDispatch));
+    fprintf(out, "dungeon_missed_deadlines_total{job=\"verify\"} %lu\n", counter(&stats->missedVerify));
+    fprintf(out, "dungeon_missed_deadlines_total{job=\"trap_judge\"} %lu\n", counter(&stats->missedTrapJudge));
+    metric_header(out, "dungeon_games_total", "counter", "Games by admission event.");
+    fprintf(out, "dungeon_games_total{event=\"admitted\"} %lu\n", counter(&stats->gamesAdmitted));
+    fprintf(out, "dungeon_games_total{event=\"deferred\"} %lu\n", counter(&stats->gamesDeferred));
+    fprintf(out, "dungeon_games_total{event=\"rejected\"} %lu\n", counter(&stats->gamesRejected));
+    fprintf(out, "dungeon_games_total{event=\"finished\"} %lu\n", counter(&stats->gamesFinished));
+
+    metric_header(out, "dungeon_hosts_attached_total", "counter", "Hosts that attached to the segment.");
+    fprintf(out, "dungeon_hosts_attached_total %lu\n", counter(&host->hostsAttached));
+    metric_header(out, "dungeon_character_rooms_total", "counter", "Rooms the hosted characters completed, by character.");
+    fprintf(out, "dungeon_character_rooms_total{character=\"barbarian\"} %lu\n", counter(&host->roomsCompleted[ROLE_BARBARIAN]));
+    fprintf(out, "dungeon_character_rooms_total{character=\"wizard\"} %lu\n", counter(&host->roomsCompleted[ROLE_WIZARD]));
+    fprintf(out, "dungeon_character_rooms_total{character=\"rogue\"} %lu\n", counter(&host->roomsCompleted[ROLE_ROGUE]));
+    metric_header(out, "dungeon_lever_takes_total", "counter", "Levers taken in treasure rooms.");
+    fprintf(out, "dungeon_lever_takes_total %lu\n", counter(&host->leverTakes));
+    metric_header(out, "dungeon_lever_waits_total", "counter", "Lever takes that had to wait for a lever.");
+    fprintf(out, "dungeon_lever_waits_total %lu\n", counter(&host->leverWaits));
+    metric_header(out, "dungeon_lever_wait_seconds_total", "counter", "Time spent waiting for levers.");
+    fprintf(out, "dungeon_lever_wait_seconds_total %.9f\n", (double)counter(&host->leverWaitNs) / NSEC_PER_SEC);
+    metric_header(out, "dungeon_character_crashes_total", "counter", "Character processes killed by a signal.");
+    fprintf(out, "dungeon_character_crashes_total %lu\n", counter(&host->workersCrashed));
+
+    write_latency(out, "dungeon_room_latency_seconds", "Time from a room opening to a hosted character completing it.",
+                  &host->latency);
+}
+
+/*
+ * export_file - Writes the metrics to @path through a temporary file and a rename.
+ * @path: The .prom file the textfile collector reads.
+ * Returns true on success.
+ */
+static bool export_file(const char *path) {
+    char temp[4096];
+    if (snprintf(temp, sizeof(temp), "%s.%d.tmp", path, getpid()) >= (int)sizeof(temp)) {
+        fprintf(stderr, "EXPORTER: output path is too long.\n");
+        return false;
+    }
+    FILE *out = fopen(temp, "w");
+    if (out == NULL) {
+        perror("EXPORTER: fopen failed");
+        return false;
+    }
+    write_metrics(out);
+    bool ok = fflush(out) == 0 && fsync(fileno(out)) == 0;
+    if (fclose(out) != 0 || !ok) {
+        perror("EXPORTER: write failed");
+        unlink(temp);
+        return false;
+    }
+    if (rename(temp, path) == -1) {
+        perror("EXPORTER: rename failed");
+        unlink(temp);
+        return false;
+    }
+    return true;
+}
+
+/*
+ * main - Exports the counters every interval until SIGINT or SIGTERM, or once with -1.
+ */
+int main(int argc, char *argv[]) {
+    const char *path = EXPORTER_FILE;
+    long long interval = EXPORTER_INTERVAL;
+    bool once = false;
+    int option;
+    while ((option = getopt(argc, argv, "o:i:1")) != -1) {
+        switch (option) {
+        case 'o': path = optarg; break;
+        case 'i': interval = atoi(optarg); break;
+        case '1': once = true; break;
+        default:
+            fprintf(stderr, "Usage: %s [-o file] [-i interval_ms] [-1]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (interval < 1) {
+        fprintf(stderr, "EXPORTER: the interval must be positive.\n");
+        return EXIT_FAILURE;
+    }
+    printf("[EXPORTER] Process started. PID: %d. Writing %s every %lld ms.\n", getpid(), path, interval);
+
+    struct sigaction sa_exit;
+    memset(&sa_exit, 0, sizeof(sa_exit));
+    sa_exit.sa_handler = sigint_handler;
+    if (sigaction(SIGINT, &sa_exit, NULL) == -1 || sigaction(SIGTERM, &sa_exit, NULL) == -1) {
+        perror("EXPORTER: sigaction failed");
+    }
+
+    unsigned long exports = 0;
+    long long next = clock_now();
+    while (exit_flag == 0) {
+        attach();
+        if (export_file(path)) {
+            exports++;
+        }
+        if (once) {
+            break;
+        }
+        // Keep a fixed period, however long the write took.
+        next += interval * (NSEC_PER_SEC / 1000);
+        long long wait = next - clock_now();
+        if (wait > 0) {
+            clock_sleep(wait);
+        } else {
+            next = clock_now();
+        }
+    }
+
+    detach();
+    printf("[EXPORTER] Wrote %lu snapshots. Exiting.\n", exports);
+    return EXIT_SUCCESS;
+}
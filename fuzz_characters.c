@@ -0,0 +1,58 @@
+/*
+ * fuzz_characters.c - The characters' room handlers, built for the fuzzer (fuzz_dungeon.c).
+ * Includes the character runtime and the Barbarian, Wizard and Rogue sources with their mains
+ * renamed, so the fuzzer can call each serve function in-process on a Dungeon it controls.
+ * This is the only file built with coverage instrumentation, so the coverage the fuzzer
+ * steers by is the characters' and not its own.
+ */
+#include "character.c"
+
+#define main barbarian_main
+#include "barbarian.c"
+#undef main
+
+#define main wizard_main
+#include "wizard.c"
+#undef main
+
+#undef _DEFAULT_SOURCE  // features.h has set it to 1; rogue.c defines it again
+#define main rogue_main
+#include "rogue.c"
+#undef main
+
+// Stands in for ROGUE_HISTORY_FILE, so inputs do not learn from each other through the file.
+static struct PickHistory fuzz_history;
+
+/*
+ * fuzz_characters_reset - Points all three characters at @dungeon and the levers at @lever_sems,
+ * as character_attach would, and gives the Rogue an empty trap history.
+ * @dungeon: The Dungeon the next handler runs on.
+ * @lever_sems: Lever One and Lever Two.
+ */
+void fuzz_characters_reset(struct Dungeon *dungeon, sem_t *lever_sems) {
+    struct Character *characters[ROLE_COUNT] = {
+        [ROLE_WIZARD] = &wizard, [ROLE_BARBARIAN] = &barbarian, [ROLE_ROGUE] = &rogue};
+    for (int i = 0; i < ROLE_COUNT; i++) {
+        characters[i]->dungeon = dungeon;
+        characters[i]->levers[LEVER_ONE] = &lever_sems[LEVER_ONE];
+        characters[i]->levers[LEVER_TWO] = &lever_sems[LEVER_TWO];
+    }
+    dungeon_ptr = dungeon;
+    memset(&fuzz_history, 0, sizeof(fuzz_history));
+    fuzz_history.magic = HISTORY_MAGIC;
+    history = &fuzz_history;
+}
+
+/*
+ * fuzz_characters_serve - Runs the serve function of the character playing @role.
+ * @role: enum CharacterRole.
+ * @signum: DUNGEON_SIGNAL or SEMAPHORE_SIGNAL.
+ * @room: Room sequence number passed to the handler.
+ */
+void fuzz_characters_serve(int role, int signum, unsigned int room) {
+    switch (role) {
+    case ROLE_BARBARIAN: barbarian.serve(signum, room); break;
+    case ROLE_WIZARD: wizard.serve(signum, room); break;
+    default: rogue.serve(signum, room); break;
+    }
+}
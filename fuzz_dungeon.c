@@ -0,0 +1,587 @@
+/*
+ * fuzz_dungeon.c - Coverage-guided fuzzer for the characters' side of the shared segment.
+ * The characters trust every byte of struct Dungeon, so this drives their room handlers
+ * (fuzz_characters.c) in-process against Dungeon states built from the input, with a thread
+ * playing a hostile dungeon alongside, and fails on crashes, sanitizer reports and stalls:
+ * a handler that is still running FUZZ_LATENCY_BUDGET after its room closed.
+ *
+ * Input layout:
+ *   byte 0         - which handler runs (fuzz_targets[], modulo their number)
+ *   next bytes     - raw struct Dungeon; running is forced on, the bools are made 0 or 1,
+ *                    and a short input leaves the rest zero. A lever with an owner starts
+ *                    taken and nobody releases it, like one whose holder died
+ *   then 6 bytes   - per script event, applied by the dungeon thread while the handler runs:
+ *                    {direction, action bits (FUZZ_*), float value}
+ * The dungeon thread applies an event whenever the Rogue has published a pick, or after
+ * FUZZ_EVENT_WAIT otherwise. When the script ends it closes the room: a trap unlocks
+ * (direction '-'), any other room ends the dungeon (running false).
+ *
+ * Built with `make fuzz_dungeon`, it carries its own small fuzzing loop, fed by gcc's
+ * -fsanitize-coverage=trace-pc. Defining FUZZ_LIBFUZZER leaves only LLVMFuzzerTestOneInput
+ * for clang's libFuzzer (see the Makefile).
+ *
+ * Usage: ./fuzz_dungeon [-S seed] [-n runs] [-t seconds] [-b budget_ms]   fuzz, saving failures
+ *        ./fuzz_dungeon input...                                           replay saved inputs
+ * A failing input is written to crash-<hash> (crash or sanitizer report) or timeout-<hash> (stall).
+ */
+
+// Include necessary headers for system calls and standard libraries.
+#define _XOPEN_SOURCE 700       // Ensure POSIX features are available
+#define _POSIX_C_SOURCE 200809L // Ensure POSIX.1-2008 compliance
+
+#include <fcntl.h>      // For open
+#include <math.h>       // For INFINITY, NAN
+#include <pthread.h>    // For the dungeon thread
+#include <semaphore.h>  // For the lever semaphores
+#include <signal.h>     // For sigaction
+#include <stdint.h>     // For uint8_t, uint64_t, uintptr_t
+#include <stdio.h>      // For printf, fprintf
+#include <stdlib.h>     // For malloc, free, abort
+#include <string.h>     // For memcpy, memset
+#include <unistd.h>     // For getopt, write
+
+#include "dungeon_info.h"       // Defines the resource names the characters expect
+#include "dungeon_settings.h"
+#include "dungeon_clock.h"
+#include "dungeon_levers.h"
+
+// Longest a handler may keep running once its room has closed, in milliseconds.
+#define FUZZ_LATENCY_BUDGET (250)
+// Longest the dungeon thread waits for the Rogue to publish a pick before the next event.
+#define FUZZ_EVENT_WAIT (NSEC_PER_SEC / 1000)
+// How often the dungeon thread looks at the segment while it waits.
+#define FUZZ_POLL (50 * NSEC_PER_USEC)
+// Script events after the first FUZZ_MAX_EVENTS are ignored, which bounds a run.
+#define FUZZ_MAX_EVENTS (32)
+#define FUZZ_EVENT_SIZE (6)
+#define FUZZ_MAX_INPUT (1 + sizeof(struct Dungeon) + FUZZ_MAX_EVENTS * FUZZ_EVENT_SIZE)
+
+// Script event actions, as bits of the event's second byte.
+#define FUZZ_SET_DIRECTION (0x01)   // trap.direction = direction
+#define FUZZ_SET_PICK (0x02)        // rogue.pick = value
+#define FUZZ_TOGGLE_LOCK (0x04)     // trap.locked = !trap.locked
+#define FUZZ_DROP_TREASURE (0x08)   // treasure[value bits % 4] = direction
+#define FUZZ_TAKE_LEVER (0x10)      // Hold lever (direction & 1) until the handler returns
+#define FUZZ_SET_DEADLINE (0x20)    // roomDeadline = now + value bits microseconds (signed)
+#define FUZZ_SET_SPOILS (0x40)      // spoils[3] = direction
+#define FUZZ_STOP (0x80)            // running = false
+
+// Provided by fuzz_characters.c.
+void fuzz_characters_reset(struct Dungeon *dungeon, sem_t *lever_sems);
+void fuzz_characters_serve(int role, int signum, unsigned int room);
+
+// The handlers an input can run.
+static const struct FuzzTarget {
+    const char *name;
+    int role;
+    int signum;
+} fuzz_targets[] = {
+    {"barbarian monster", ROLE_BARBARIAN, DUNGEON_SIGNAL},
+    {"wizard barrier", ROLE_WIZARD, DUNGEON_SIGNAL},
+    {"rogue trap", ROLE_ROGUE, DUNGEON_SIGNAL},
+    {"barbarian treasure", ROLE_BARBARIAN, SEMAPHORE_SIGNAL},
+    {"wizard treasure", ROLE_WIZARD, SEMAPHORE_SIGNAL},
+    {"rogue treasure", ROLE_ROGUE, SEMAPHORE_SIGNAL},
+};
+#define FUZZ_TARGETS ((int)(sizeof(fuzz_targets) / sizeof(fuzz_targets[0])))
+
+// State shared between the handler (main thread) and the dungeon thread for one input.
+struct FuzzRun {
+    const struct FuzzTarget *target;
+    const uint8_t *events;
+    int eventCount;
+    bool done;                 // The handler returned
+    long long closedAt;        // When the room closed, 0 while it is open
+};
+
+static struct Dungeon fuzz_dungeon;
+static sem_t fuzz_levers[2];
+static bool fuzz_ready = false;
+static long long fuzz_budget = FUZZ_LATENCY_BUDGET * 1000000LL;
+static long long fuzz_slowest = 0;          // Largest latency seen
+static const uint8_t *fuzz_input = NULL;    // The input running now, saved if it fails
+static size_t fuzz_input_size = 0;
+static volatile sig_atomic_t fuzz_stalled = 0; // The abort is for a stall, not a crash
+
+/*
+ * fuzz_wait - Sleeps in FUZZ_POLL steps until @until, the handler returns or (with @for_pick)
+ * the Rogue publishes a pick. Returns true once the handler has returned.
+ */
+static bool fuzz_wait(struct FuzzRun *run, long long until, bool for_pick) {
+    while (!__atomic_load_n(&run->done, __ATOMIC_ACQUIRE)) {
+        if (clock_now() >= until || (for_pick && fuzz_dungeon.trap.direction == 't')) {
+            return false;
+        }
+        clock_sleep(FUZZ_POLL);
+    }
+    return true;
+}
+
+/*
+ * fuzz_apply - Applies one script event to the segment.
+ * @held: Levers taken so far, released once the handler returns.
+ */
+static void fuzz_apply(const uint8_t *event, bool held[2]) {
+    char direction = (char)event[0];
+    uint8_t action = event[1];
+    float value;
+    int32_t bits;
+    memcpy(&value, event + 2, sizeof(value));
+    memcpy(&bits, event + 2, sizeof(bits));
+
+    if (action & FUZZ_SET_DIRECTION) fuzz_dungeon.trap.direction = direction;
+    if (action & FUZZ_SET_PICK) fuzz_dungeon.rogue.pick = value;
+    if (action & FUZZ_TOGGLE_LOCK) fuzz_dungeon.trap.locked = !fuzz_dungeon.trap.locked;
+    if (action & FUZZ_DROP_TREASURE) fuzz_dungeon.treasure[(uint32_t)bits % 4] = direction;
+    if (action & FUZZ_TAKE_LEVER) {
+        int lever = direction & 1;
+        if (!held[lever] && lever_take(&fuzz_dungeon.levers[lever], &fuzz_levers[lever], false)) {
+            held[lever] = true;
+        }
+    }
+    if (action & FUZZ_SET_DEADLINE) {
+        __atomic_store_n(&fuzz_dungeon.roomDeadline, clock_now() + (long long)bits * NSEC_PER_USEC, __ATOMIC_RELEASE);
+    }
+    if (action & FUZZ_SET_SPOILS) fuzz_dungeon.spoils[3] = direction;
+    if (action & FUZZ_STOP) fuzz_dungeon.running = false;
+}
+
+/*
+ * fuzz_dungeon_thread - Plays the dungeon: runs the script, closes the room and then gives
+ * the handler FUZZ_LATENCY_BUDGET to return before reporting a stall.
+ */
+static void *fuzz_dungeon_thread(void *arg) {
+    struct FuzzRun *run = arg;
+    bool trap = run->target->role == ROLE_ROGUE && run->target->signum == DUNGEON_SIGNAL;
+    bool held[2] = {false, false};
+    bool returned = false;
+
+    for (int i = 0; i < run->eventCount && !returned; i++) {
+        returned = fuzz_wait(run, clock_now() + FUZZ_EVENT_WAIT, trap);
+        if (!returned) {
+            fuzz_apply(run->events + i * FUZZ_EVENT_SIZE, held);
+        }
+    }
+
+    if (!__atomic_load_n(&run->done, __ATOMIC_ACQUIRE)) {
+        if (trap) {
+            fuzz_dungeon.trap.direction = '-';
+            fuzz_dungeon.trap.locked = false;
+        } else {
+            fuzz_dungeon.running = false;
+        }
+        run->closedAt = clock_now();
+        if (!fuzz_wait(run, run->closedAt + fuzz_budget, false)) {
+            fprintf(stderr, "FUZZ: %s handler still running %lld ms after its room closed.\n",
+                    run->target->name, fuzz_budget / 1000000);
+            fuzz_stalled = true;
+            abort();
+        }
+    }
+
+    for (int lever = 0; lever < 2; lever++) {
+        if (held[lever]) {
+            lever_release(&fuzz_dungeon.levers[lever], &fuzz_levers[lever]);
+        }
+    }
+    return NULL;
+}
+
+/*
+ * fuzz_setup - Sends the characters' chatter to /dev/null; the fuzzer reports on stderr.
+ */
+static void fuzz_setup(void) {
+    if (freopen("/dev/null", "w", stdout) == NULL) {
+        perror("FUZZ: freopen /dev/null failed");
+    }
+}
+
+/*
+ * LLVMFuzzerTestOneInput - Runs one input: builds the Dungeon, starts the dungeon thread and
+ * serves the room. Returns 0, as libFuzzer expects.
+ */
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    if (size < 1) {
+        return 0;
+    }
+    fuzz_input = data;
+    fuzz_input_size = size;
+
+    // --- Build the segment ---
+    struct FuzzRun run;
+    memset(&run, 0, sizeof(run));
+    run.target = &fuzz_targets[data[0] % FUZZ_TARGETS];
+    size_t state = size - 1 < sizeof(struct Dungeon) ? size - 1 : sizeof(struct Dungeon);
+    memset(&fuzz_dungeon, 0, sizeof(fuzz_dungeon));
+    memcpy(&fuzz_dungeon, data + 1, state);
+    *(unsigned char *)&fuzz_dungeon.running = 1;
+    *(unsigned char *)&fuzz_dungeon.trap.locked &= 1;
+    if (size - 1 > state) {
+        run.events = data + 1 + state;
+        run.eventCount = (int)((size - 1 - state) / FUZZ_EVENT_SIZE);
+        if (run.eventCount > FUZZ_MAX_EVENTS) {
+            run.eventCount = FUZZ_MAX_EVENTS;
+        }
+    }
+
+    // --- Fresh levers: one with an owner in the segment starts taken, as if its holder died ---
+    for (int lever = 0; lever < 2; lever++) {
+        if (fuzz_ready) {
+            sem_destroy(&fuzz_levers[lever]);
+        }
+        sem_init(&fuzz_levers[lever], 0, fuzz_dungeon.levers[lever].owner == 0 ? 1 : 0);
+    }
+    fuzz_ready = true;
+    fuzz_characters_reset(&fuzz_dungeon, fuzz_levers);
+
+    // --- Serve the room against the dungeon thread ---
+    pthread_t dungeon_thread;
+    if (pthread_create(&dungeon_thread, NULL, fuzz_dungeon_thread, &run) != 0) {
+        perror("FUZZ: pthread_create failed");
+        abort();
+    }
+    fuzz_characters_serve(run.target->role, run.target->signum, fuzz_dungeon.roomSeq);
+    long long returned_at = clock_now();
+    __atomic_store_n(&run.done, true, __ATOMIC_RELEASE);
+    pthread_join(dungeon_thread, NULL);
+
+    if (run.closedAt != 0 && returned_at - run.closedAt > fuzz_slowest) {
+        fuzz_slowest = returned_at - run.closedAt;
+    }
+    fuzz_input = NULL;
+    return 0;
+}
+
+#ifdef FUZZ_LIBFUZZER
+
+/*
+ * LLVMFuzzerInitialize - libFuzzer's setup hook.
+ */
+int LLVMFuzzerInitialize(int *argc, char ***argv) {
+    (void)argc;
+    (void)argv;
+    fuzz_setup();
+    return 0;
+}
+
+#else
+
+// --- Coverage ---
+// gcc calls __sanitizer_cov_trace_pc at every edge of the code built with
+// -fsanitize-coverage=trace-pc (fuzz_characters.c). Each pair of consecutive edges sets a byte
+// in the map, as in AFL, so the map records which paths through the handlers an input took.
+#define FUZZ_MAP_SIZE (1 << 16)
+
+static uint8_t fuzz_map[FUZZ_MAP_SIZE];     // Edges the running input reached
+static uint8_t fuzz_seen[FUZZ_MAP_SIZE];    // Edges any input reached
+static uintptr_t fuzz_previous = 0;
+
+void __sanitizer_cov_trace_pc(void) {
+    uintptr_t pc = (uintptr_t)__builtin_return_address(0);
+    fuzz_map[(pc ^ fuzz_previous) % FUZZ_MAP_SIZE] = 1;
+    fuzz_previous = pc >> 1;
+}
+
+/*
+ * fuzz_save - Writes the running input to <prefix><hash>. Safe to call from a signal handler.
+ */
+static void fuzz_save(const char *prefix) {
+    if (fuzz_input == NULL) {
+        return;
+    }
+    uint64_t hash = 14695981039346656037ULL; // FNV-1a
+    for (size_t i = 0; i < fuzz_input_size; i++) {
+        hash = (hash ^ fuzz_input[i]) * 1099511628211ULL;
+    }
+    char path[64];
+    size_t length = strlen(prefix);
+    memcpy(path, prefix, length);
+    for (int shift = 60; shift >= 0; shift -= 4) {
+        path[length++] = "0123456789abcdef"[(hash >> shift) & 0xf];
+    }
+    path[length] = '\0';
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd == -1) {
+        return;
+    }
+    bool saved = write(fd, fuzz_input, fuzz_input_size) == (ssize_t)fuzz_input_size;
+    close(fd);
+    if (!saved) {
+        return;
+    }
+    // stdio is not safe in a signal handler, so the report is one write.
+    char report[96] = "FUZZ: input saved to ";
+    size_t used = strlen(report);
+    memcpy(report + used, path, length);
+    used += length;
+    report[used++] = '\n';
+    if (write(STDERR_FILENO, report, used) < 0) {
+        return;
+    }
+}
+
+// Makes the address and undefined behaviour sanitizers abort after a report, so
+// fuzz_crash_handler saves the input that caused it.
+const char *__asan_default_options(void) {
+    return "abort_on_error=1";
+}
+
+const char *__ubsan_default_options(void) {
+    return "abort_on_error=1:print_stacktrace=1";
+}
+
+static void fuzz_crash_handler(int signum) {
+    fuzz_save(signum == SIGABRT && fuzz_stalled ? "timeout-" : "crash-");
+    signal(signum, SIG_DFL);
+    raise(signum);
+}
+
+// --- Corpus ---
+struct FuzzInput {
+    uint8_t *data;
+    size_t size;
+};
+
+#define FUZZ_MAX_CORPUS (4096)
+static struct FuzzInput fuzz_corpus[FUZZ_MAX_CORPUS];
+static int fuzz_corpus_size = 0;
+static uint64_t fuzz_rng;
+
+static uint64_t fuzz_random(void) {
+    fuzz_rng ^= fuzz_rng << 13; // xorshift64
+    fuzz_rng ^= fuzz_rng >> 7;
+    fuzz_rng ^= fuzz_rng << 17;
+    return fuzz_rng;
+}
+
+/*
+ * fuzz_run_input - Runs an input with a clean coverage map and returns how many edges it
+ * reached that no input had reached before. Inputs that reach new edges join the corpus.
+ */
+static int fuzz_run_input(const uint8_t *data, size_t size) {
+    memset(fuzz_map, 0, sizeof(fuzz_map));
+    fuzz_previous = 0;
+    LLVMFuzzerTestOneInput(data, size);
+    int fresh = 0;
+    for (int i = 0; i < FUZZ_MAP_SIZE; i++) {
+        if (fuzz_map[i] && !fuzz_seen[i]) {
+            fuzz_seen[i] = 1;
+            fresh++;
+        }
+    }
+    if (fresh > 0 && fuzz_corpus_size < FUZZ_MAX_CORPUS) {
+        uint8_t *copy = malloc(size);
+        if (copy != NULL) {
+            memcpy(copy, data, size);
+            fuzz_corpus[fuzz_corpus_size].data = copy;
+            fuzz_corpus[fuzz_corpus_size].size = size;
+            fuzz_corpus_size++;
+        }
+    }
+    return fresh;
+}
+
+/*
+ * fuzz_event - Writes a script event into @event.
+ */
+static void fuzz_event(uint8_t *event, char direction, uint8_t action, float value) {
+    event[0] = (uint8_t)direction;
+    event[1] = action;
+    memcpy(event + 2, &value, sizeof(value));
+}
+
+/*
+ * fuzz_seed - Runs one well-formed input per handler: a locked trap the script answers,
+ * a barrier with a short spell, a monster, and a treasure room the script fills.
+ */
+static void fuzz_seed(void) {
+    uint8_t input[FUZZ_MAX_INPUT];
+    for (int target = 0; target < FUZZ_TARGETS; target++) {
+        struct Dungeon dungeon;
+        memset(&dungeon, 0, sizeof(dungeon));
+        dungeon.running = true;
+        dungeon.rogue.pick = MAX_PICK_ANGLE / 2.0;
+        dungeon.trap.direction = 't';
+        dungeon.trap.locked = true;
+        dungeon.enemy.health = 42;
+        strcpy(dungeon.barrier.spell, "\x03Khoor zruog");
+        dungeon.roomSeq = 1;
+
+        input[0] = (uint8_t)target;
+        memcpy(input + 1, &dungeon, sizeof(dungeon));
+        uint8_t *events = input + 1 + sizeof(dungeon);
+        int count = 0;
+        if (fuzz_targets[target].signum == DUNGEON_SIGNAL) {
+            fuzz_event(events + FUZZ_EVENT_SIZE * count++, 'u', FUZZ_SET_DIRECTION, 0.0);
+            fuzz_event(events + FUZZ_EVENT_SIZE * count++, 'd', FUZZ_SET_DIRECTION, 0.0);
+            fuzz_event(events + FUZZ_EVENT_SIZE * count++, '-', FUZZ_SET_DIRECTION, 0.0);
+        } else {
+            float slot;
+            for (int i = 0; i < 4; i++) {
+                int32_t bits = i;
+                memcpy(&slot, &bits, sizeof(slot));
+                fuzz_event(events + FUZZ_EVENT_SIZE * count++, "Gold"[i], FUZZ_DROP_TREASURE, slot);
+            }
+            fuzz_event(events + FUZZ_EVENT_SIZE * count++, 'd', FUZZ_SET_SPOILS, 0.0);
+        }
+        fuzz_run_input(input, 1 + sizeof(dungeon) + FUZZ_EVENT_SIZE * count);
+    }
+}
+
+/*
+ * fuzz_mutate - Applies one to four random mutations to @data in place.
+ * Returns the new size, at most FUZZ_MAX_INPUT.
+ */
+static size_t fuzz_mutate(uint8_t *data, size_t size) {
+    static const uint8_t bytes[] = {0, 1, 0x7f, 0x80, 0xff, 't', 'u', 'd', '-', 'w'};
+    static const float floats[] = {0.0, -0.0, -1.0, 1.0, LOCK_THRESHOLD, MAX_PICK_ANGLE / 2.0, MAX_PICK_ANGLE,
+                                   1e30, -1e30, INFINITY, -INFINITY, NAN};
+    static const int32_t ints[] = {0, 1, -1, 0x7fffffff, -0x7fffffff - 1, 0x10000, 100};
+    int mutations = 1 + (int)(fuzz_random() % 4);
+    for (int m = 0; m < mutations; m++) {
+        size_t at = (size_t)(fuzz_random() % size);
+        switch (fuzz_random() % 8) {
+        case 0: data[at] ^= (uint8_t)(1u << (fuzz_random() % 8)); break;
+        case 1: data[at] = (uint8_t)fuzz_random(); break;
+        case 2: data[at] = bytes[fuzz_random() % sizeof(bytes)]; break;
+        case 3:
+            if (at + sizeof(float) <= size) {
+                memcpy(data + at, &floats[fuzz_random() % (sizeof(floats) / sizeof(floats[0]))], sizeof(float));
+            }
+            break;
+        case 4:
+            if (at + sizeof(int32_t) <= size) {
+                memcpy(data + at, &ints[fuzz_random() % (sizeof(ints) / sizeof(ints[0]))], sizeof(int32_t));
+            }
+            break;
+        case 5: // Append a random event
+            if (size + FUZZ_EVENT_SIZE <= FUZZ_MAX_INPUT) {
+                for (int i = 0; i < FUZZ_EVENT_SIZE; i++) {
+                    data[size++] = (uint8_t)fuzz_random();
+                }
+            }
+            break;
+        case 6: // Drop the last event
+            if (size > 1 + sizeof(struct Dungeon) + FUZZ_EVENT_SIZE) {
+                size -= FUZZ_EVENT_SIZE;
+            }
+            break;
+        default: { // Splice in a piece of another corpus entry
+            const struct FuzzInput *other = &fuzz_corpus[fuzz_random() % fuzz_corpus_size];
+            if (at < other->size) {
+                size_t length = 1 + (size_t)(fuzz_random() % 32);
+                if (at + length > other->size) length = other->size - at;
+                if (at + length > size) length = size - at;
+                memcpy(data + at, other->data + at, length);
+            }
+            break;
+        }
+        }
+    }
+    return size;
+}
+
+/*
+ * fuzz_replay - Runs saved inputs once each, e.g. to check a fix against a crash file.
+ */
+static int fuzz_replay(int count, char *paths[]) {
+    uint8_t *data = malloc(FUZZ_MAX_INPUT);
+    if (data == NULL) {
+        perror("FUZZ: malloc failed");
+        return EXIT_FAILURE;
+    }
+    for (int i = 0; i < count; i++) {
+        FILE *file = fopen(paths[i], "rb");
+        if (file == NULL) {
+            perror("FUZZ: fopen failed");
+            free(data);
+            return EXIT_FAILURE;
+        }
+        size_t size = fread(data, 1, FUZZ_MAX_INPUT, file);
+        fclose(file);
+        long long start = clock_now();
+        LLVMFuzzerTestOneInput(data, size);
+        fprintf(stderr, "%s: %s, %zu bytes, passed in %.3f ms.\n", paths[i], fuzz_targets[size ? data[0] % FUZZ_TARGETS : 0].name,
+                size, (clock_now() - start) / 1e6);
+    }
+    free(data);
+    return EXIT_SUCCESS;
+}
+
+/*
+ * main - Fuzzes the handlers for a number of runs or seconds, or replays the given inputs.
+ */
+int main(int argc, char *argv[]) {
+    uint64_t seed = (uint64_t)getpid();
+    long long runs = 0;
+    int seconds = 10;
+    int option;
+    while ((option = getopt(argc, argv, "S:n:t:b:")) != -1) {
+        switch (option) {
+        case 'S': seed = (uint64_t)strtoull(optarg, NULL, 10); break;
+        case 'n': runs = atoll(optarg); break;
+        case 't': seconds = atoi(optarg); break;
+        case 'b': fuzz_budget = atoll(optarg) * 1000000LL; break;
+        default:
+            fprintf(stderr, "Usage: %s [-S seed] [-n runs] [-t seconds] [-b budget_ms] [input...]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    fuzz_setup();
+    // Save the input on a crash. The sanitizers already handle SIGSEGV and friends and
+    // abort afterwards, so those handlers are only installed where nothing else has one.
+    struct sigaction crash;
+    memset(&crash, 0, sizeof(crash));
+    crash.sa_handler = fuzz_crash_handler;
+    sigaction(SIGABRT, &crash, NULL);
+    int signals[] = {SIGSEGV, SIGBUS, SIGFPE};
+    for (int i = 0; i < 3; i++) {
+        struct sigaction current;
+        if (sigaction(signals[i], NULL, &current) == 0 && current.sa_handler == SIG_DFL) {
+            sigaction(signals[i], &crash, NULL);
+        }
+    }
+
+    if (optind < argc) {
+        return fuzz_replay(argc - optind, argv + optind);
+    }
+
+    fuzz_rng = seed ? seed : 1;
+    fuzz_seed();
+    uint8_t *input = malloc(FUZZ_MAX_INPUT);
+    if (input == NULL) {
+        perror("FUZZ: malloc failed");
+        return EXIT_FAILURE;
+    }
+
+    long long start = clock_now();
+    long long stop = start + seconds * NSEC_PER_SEC;
+    long long executed = 0;
+    int edges = 0;
+    for (int i = 0; i < FUZZ_MAP_SIZE; i++) {
+        edges += fuzz_seen[i];
+    }
+    while ((runs > 0) ? executed < runs : clock_now() < stop) {
+        const struct FuzzInput *parent = &fuzz_corpus[fuzz_random() % fuzz_corpus_size];
+        memcpy(input, parent->data, parent->size);
+        size_t size = fuzz_mutate(input, parent->size);
+        int fresh = fuzz_run_input(input, size);
+        executed++;
+        if (fresh > 0) {
+            edges += fresh;
+            fprintf(stderr, "#%lld NEW edges: %d corpus: %d (%s)\n", executed, edges, fuzz_corpus_size,
+                    fuzz_targets[input[0] % FUZZ_TARGETS].name);
+        }
+    }
+
+    double elapsed = (clock_now() - start) / 1e9;
+    fprintf(stderr, "Done: %lld runs in %.1f s (%.0f/s), %d edges, %d inputs in the corpus, no crashes or stalls.\n",
+            executed, elapsed, executed / elapsed, edges, fuzz_corpus_size);
+    fprintf(stderr, "Slowest return after a room closed: %.3f ms (budget %lld ms).\n", fuzz_slowest / 1e6,
+            fuzz_budget / 1000000);
+    free(input);
+    return EXIT_SUCCESS;
+}
+
+#endif
@@ -21,14 +21,24 @@
 #include <stdbool.h>    // Make sure bool is available
 #include <signal.h>     // For kill(), signals (needed for pid_t and kill, even without sigaction in main)
 #include <string.h>     // For memset
+#include <pthread.h>    // For pthread_create(), pthread_join() (lever watchdog)
+#include <sys/eventfd.h> // For eventfd() (eventfd wait strategy, see character.h)
 
 // Include custom header files defining shared resources and settings.
 #include "dungeon_info.h" // Contains RunDungeon declaration and struct definitions
 #include "dungeon_settings.h" // Contains DUNGEON_SIGNAL definition and other game parameters
+#include "dungeon_levers.h" // Lever ownership helpers used by the lever watchdog
 
 // Declare the external RunDungeon function from dungeon.o
 extern void RunDungeon(pid_t wizard_pid, pid_t rogue_pid, pid_t barbarian_pid);
 
+// State shared between the Dungeon Master and the lever watchdog thread.
+struct LeverWatch {
+    struct Dungeon *dungeon_ptr; // Pointer to the shared Dungeon struct
+    sem_t *levers[2];            // Lever One and Lever Two semaphores
+    bool stop;                   // Set (atomically) to ask the watchdog to exit
+};
+
 
 // --- Function Definitions ---
 
@@ -65,8 +75,11 @@ void cleanup_resources(struct Dungeon *dungeon_ptr, int shm_fd, sem_t *lever1, s
     if (rogue_pid > 0) waitpid(rogue_pid, &status, 0);
     printf("[DUNGEON MASTER] All characters have exited.\n");
 
-    // Unmap the shared memory segment.
+    // Close the characters' eventfds, then unmap the shared memory segment.
     if (dungeon_ptr != MAP_FAILED && dungeon_ptr != NULL) {
+        for (int i = 0; i < ROLE_COUNT; i++) {
+            if (dungeon_ptr->eventFds[i] > 0) close(dungeon_ptr->eventFds[i]);
+        }
         if (munmap(dungeon_ptr, sizeof(struct Dungeon)) == -1) {
             perror("DUNGEON MASTER: munmap failed");
         }
@@ -121,6 +134,27 @@ void error_and_exit(const char *msg, struct Dungeon *dungeon_ptr, int shm_fd, se
 }
 
 
+/*
+ * lever_watchdog - Thread that reclaims levers held by characters that have died.
+ * Without it, a Barbarian or Wizard crashing after sem_wait leaves its lever at zero,
+ * and the treasure room waits out TIME_TREASURE_AVAILABLE before giving up.
+ * @arg: Pointer to the struct LeverWatch for this game.
+ */
+void *lever_watchdog(void *arg) {
+    struct LeverWatch *watch = (struct LeverWatch *)arg;
+
+    while (!__atomic_load_n(&watch->stop, __ATOMIC_ACQUIRE)) {
+        for (int lever = LEVER_ONE; lever <= LEVER_TWO; lever++) {
+            pid_t dead = lever_reclaim_if_dead(&watch->dungeon_ptr->levers[lever], watch->levers[lever]);
+            if (dead > 0) {
+                printf("[DUNGEON MASTER] Character %d died holding lever %d. Lever reclaimed.\n", dead, lever + 1);
+            }
+        }
+        usleep(LEVER_WATCH_INTERVAL);
+    }
+    return NULL;
+}
+
 /*
  * main - The main function for the Dungeon Master process.
  * Sets up shared memory and semaphores, forks character processes,
@@ -171,12 +205,24 @@ int main() {
     dungeon_ptr->running = true; // Set the flag indicating the dungeon is running.
     dungeon_ptr->dungeonPID = getpid(); // Store the Dungeon Master's PID.
 
+    // One eventfd per character for the eventfd wait strategy (see character.h). They are created
+    // without EFD_CLOEXEC so the characters inherit them across exec; engine.c writes to them.
+    for (int i = 0; i < ROLE_COUNT; i++) {
+        int event_fd = eventfd(0, EFD_NONBLOCK);
+        dungeon_ptr->eventFds[i] = (event_fd > 0) ? event_fd : 0;
+    }
+
 
     printf("[DUNGEON MASTER] Shared memory created and mapped.\n");
 
     // --- 2. Semaphore Setup ---
     printf("[DUNGEON MASTER] Creating semaphores...\n");
 
+    // Remove any levers left behind by a previous game. sem_open with O_CREAT would otherwise
+    // reuse them, and a lever left at zero by a crashed holder would poison this game too.
+    sem_unlink(dungeon_lever_one);
+    sem_unlink(dungeon_lever_two);
+
     // Create or open the first named semaphore for Lever 1.
     // O_CREAT: Create if it doesn't exist.
     // 0666: Permissions.
@@ -243,6 +289,14 @@ int main() {
     // Give children a moment to start up and connect to shared resources.
     usleep(100000); // Sleep for 100ms.
 
+    // Start watching the levers so a crashed holder's lever is reclaimed immediately.
+    struct LeverWatch watch = { dungeon_ptr, { lever1, lever2 }, false };
+    pthread_t watchdog;
+    bool watchdog_running = (pthread_create(&watchdog, NULL, lever_watchdog, &watch) == 0);
+    if (!watchdog_running) {
+        printf("[DUNGEON MASTER] Could not start the lever watchdog. Continuing without it.\n");
+    }
+
     // --- 4. Run the Dungeon Simulation ---
     printf("[DUNGEON MASTER] All characters ready. Starting the dungeon simulation!\n");
     // Call the external RunDungeon function from dungeon.o.
@@ -250,6 +304,12 @@ int main() {
     RunDungeon(wizard_pid, rogue_pid, barbarian_pid);
     printf("[DUNGEON MASTER] Dungeon simulation finished.\n");
 
+    // Stop the watchdog before the levers it uses are closed.
+    if (watchdog_running) {
+        __atomic_store_n(&watch.stop, true, __ATOMIC_RELEASE);
+        pthread_join(watchdog, NULL);
+    }
+
     // --- 5. Cleanup ---
     // Signal children to exit and wait for them, then clean up shared memory and semaphores.
     cleanup_resources(dungeon_ptr, shm_fd, lever1, lever2, barbarian_pid, wizard_pid, rogue_pid);
@@ -0,0 +1,634 @@
+/*
+ * host.c - Hosts the Barbarian, Wizard and Rogue of many games in a single process.
+ * Every character of every slot in /DungeonSlots runs as a small stackless coroutine that
+ * suspends while it waits for a room, a lever, trap feedback or treasure. See
+ * dungeon_slots.h for the slot protocol.
+ *
+ * Scheduling: each worker thread owns the games assigned to it and scans their characters.
+ * A character whose wait is over becomes a task (a mirror, a decode, one pick step, one
+ * treasure collect...) pushed on the owner's deque. Workers pop their own deque from the
+ * bottom and, when it is empty, steal from the top of another worker's deque, so a worker
+ * whose games are busy is helped by workers whose games are idle.
+ *
+ * With -p the same characters run one process each instead (no sharing, no stealing), for
+ * comparing throughput and latency against the pool.
+ *
+ * Usage: ./host [-w worker_threads] [-p]
+ */
+
+// Include necessary headers for system calls and standard libraries.
+#define _XOPEN_SOURCE 700       // Ensure POSIX features are available
+#define _POSIX_C_SOURCE 200809L // Ensure POSIX.1-2008 compliance
+#define _DEFAULT_SOURCE         // For MAP_ANONYMOUS
+
+#include <stdio.h>      // For printf, perror
+#include <stdlib.h>     // For exit, atoi
+#include <unistd.h>     // For close, getpid, fork, getopt
+#include <sys/mman.h>   // For shared memory functions (shm_open, mmap, munmap)
+#include <sys/stat.h>   // For fstat
+#include <sys/wait.h>   // For waitpid
+#include <fcntl.h>      // For file control options
+#include <signal.h>     // For sigaction
+#include <pthread.h>    // For worker threads and deque locks
+#include <stdbool.h>    // For bool type
+#include <string.h>     // For memset
+
+// Include custom header files for shared resources and settings.
+#include "dungeon_info.h"      // Defines the Dungeon struct layout
+#include "dungeon_settings.h"  // Defines game parameters
+#include "dungeon_slots.h"     // Defines the multi-game slot layout and protocol
+#include "dungeon_levers.h"    // Lever ownership helpers
+#include "dungeon_clock.h"     // Monotonic deadlines
+#include "dungeon_spell.h"     // Caesar cipher decoder
+#include "dungeon_histogram.h" // Latency histograms for the report
+
+// --- Stackless Coroutines ---
+// A task function is re-entered from the top on every resume and jumps back to where it
+// last suspended by switching on the line number saved in task->line. Anything that must
+// survive a suspension therefore lives in struct CharacterTask, not in local variables.
+// TASK_WAIT records what the task is waiting for, so the scheduler can test it with
+// task_ready() without running the coroutine.
+#define TASK_BEGIN(task) switch ((task)->line) { case 0:
+#define TASK_WAIT(task, kind)                                   \
+    do {                                                        \
+        (task)->wait = (kind);                                  \
+        (task)->line = __LINE__;                                \
+        __attribute__((fallthrough));                           \
+        case __LINE__:                                          \
+        if (!task_ready(task)) return;                          \
+    } while (0)
+#define TASK_END(task) } (task)->line = 0
+
+// What a suspended task is waiting for.
+enum TaskWait {
+    WAIT_ROOM,          // A new roomSeq in its slot
+    WAIT_LEVER,         // Either lever to become free
+    WAIT_TREASURE_DONE, // The rogue to finish while a lever is held
+    WAIT_TRAP_ANSWER,   // The engine to judge the current pick
+    WAIT_TREASURE_CHAR  // The next treasure character to appear
+};
+
+// One hosted character: its coroutine state plus everything it keeps across suspensions.
+struct CharacterTask {
+    int line;                  // Resume point of the coroutine (0 = start)
+    enum TaskWait wait;        // What the coroutine is suspended on
+    int queued;                // 1 while the task sits in a deque or is running
+    enum CharacterRole role;   // Which character this task plays
+    struct DungeonSlot *slot;  // The game this character belongs to
+    unsigned int seenSeq;      // Last roomSeq this character looked at
+    unsigned long rooms;       // Rooms this character completed
+    struct Deadline deadline;  // Close time of the current room
+    int lever;                 // Lever held in the treasure room, -1 if none
+    long long leverWait;       // When the task started waiting for a lever, 0 if it has not
+    float low;                 // Rogue: lower bound of the search
+    float high;                // Rogue: upper bound of the search
+    int spoils;                // Rogue: treasure characters collected so far
+};
+
+// Runnable tasks of one worker. The owner pushes and pops at the bottom; thieves take from the top.
+struct TaskDeque {
+    pthread_mutex_t lock;
+    struct CharacterTask **items;
+    unsigned long top;         // Next index a thief takes
+    unsigned long bottom;      // Next index the owner pushes to
+    unsigned long capacity;    // Number of tasks the owner scans; each is queued at most once
+};
+
+// A worker, the characters it owns, and its share of the statistics.
+struct Worker {
+    pthread_t thread;
+    struct CharacterTask *owned; // Characters this worker scans for readiness
+    int ownedCount;
+    struct TaskDeque deque;
+    unsigned int seed;           // Picks steal victims
+    unsigned long steps;         // Tasks run by this worker
+    unsigned long steals;        // Tasks this worker took from another deque
+};
+
+// --- Global Variables ---
+struct DungeonSlots *slots = MAP_FAILED; // The mapped multi-game segment
+size_t slots_size = 0;                   // Size of the mapping
+struct Worker *workers = NULL;           // All workers, shared with child processes in -p mode
+int worker_count = 0;                    // Number of entries in workers[]
+bool stealing = true;                    // False in -p mode, where workers are separate processes
+
+// Flag to control the workers' exit, set by the SIGINT handler.
+volatile sig_atomic_t exit_flag = 0;
+
+// --- Function Definitions ---
+
+/*
+ * sigint_handler - Handles the SIGINT signal (Ctrl+C) for graceful exit.
+ * @signum: The signal number (SIGINT).
+ */
+void sigint_handler(int signum) {
+    (void)signum;
+    exit_flag = 1;
+}
+
+/*
+ * shared_calloc - Allocates zeroed memory that stays shared with forked children.
+ * @size: Number of bytes.
+ */
+void *shared_calloc(size_t size) {
+    void *memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    return memory == MAP_FAILED ? NULL : memory;
+}
+
+/*
+ * stat_add - Adds to one of the shared host counters.
+ * @counter: A field of slots->host.
+ * @amount: How much to add.
+ */
+static inline void stat_add(unsigned long *counter, unsigned long amount) {
+    __atomic_fetch_add(counter, amount, __ATOMIC_RELAXED);
+}
+
+/*
+ * trap_answered - Returns true when the engine has judged the current pick.
+ * @dungeon: The game state.
+ */
+static bool trap_answered(SlotDungeon *dungeon) {
+    char direction = __atomic_load_n(&dungeon->trap.direction, __ATOMIC_ACQUIRE);
+    return direction == 'u' || direction == 'd' || direction == '-' || !dungeon->trap.locked;
+}
+
+/*
+ * task_ready - Returns true if the condition a task is suspended on may now hold.
+ * Has no side effects, so the owner can call it on any task that is not queued.
+ * @task: The character task.
+ */
+static bool task_ready(struct CharacterTask *task) {
+    struct DungeonSlot *slot = task->slot;
+    SlotDungeon *dungeon = &slot->dungeon;
+    int one = 0, two = 0;
+
+    switch (task->wait) {
+    case WAIT_ROOM:
+        return __atomic_load_n(&slot->roomSeq, __ATOMIC_ACQUIRE) != task->seenSeq;
+    case WAIT_LEVER:
+        sem_getvalue(&slot->levers[LEVER_ONE], &one);
+        sem_getvalue(&slot->levers[LEVER_TWO], &two);
+        return one > 0 || two > 0 || deadline_passed(&task->deadline);
+    case WAIT_TREASURE_DONE:
+        return dungeon->spoils[3] != '\0' || !dungeon->running || deadline_passed(&task->deadline);
+    case WAIT_TRAP_ANSWER:
+        return trap_answered(dungeon) || deadline_passed(&task->deadline);
+    case WAIT_TREASURE_CHAR:
+        return dungeon->treasure[task->spoils] != '\0' || deadline_passed(&task->deadline);
+    }
+    return true;
+}
+
+/*
+ * room_done - Counts a completed room and records how long after it opened that was, in the
+ * task and in slots->host.
+ * @task: The character task.
+ */
+static void room_done(struct CharacterTask *task) {
+    task->rooms++;
+    stat_add(&slots->host.roomsCompleted[task->role], 1);
+    long long opened = task->slot->roomOpened;
+    if (opened > 0) {
+        histogram_record_shared(&slots->host.latency, clock_now() - opened);
+    }
+}
+
+/*
+ * take_any_lever - Tries to take a lever without blocking, preferred lever first.
+ * @task: The character task; task->lever is set to the lever taken.
+ * @preferred: The lever to try first.
+ * Returns true if a lever is now held.
+ */
+static bool take_any_lever(struct CharacterTask *task, int preferred) {
+    struct DungeonSlot *slot = task->slot;
+    int other = (preferred == LEVER_ONE) ? LEVER_TWO : LEVER_ONE;
+    if (lever_take(&slot->dungeon.levers[preferred], &slot->levers[preferred], false)) {
+        task->lever = preferred;
+    } else if (lever_take(&slot->dungeon.levers[other], &slot->levers[other], false)) {
+        task->lever = other;
+    }
+    return task->lever >= 0;
+}
+
+/*
+ * lever_taken - Counts a lever taken, and how long the task waited for it if it had to.
+ * @task: The character task, holding a lever.
+ */
+static void lever_taken(struct CharacterTask *task) {
+    stat_add(&slots->host.leverTakes, 1);
+    if (task->leverWait > 0) {
+        stat_add(&slots->host.leverWaits, 1);
+        stat_add(&slots->host.leverWaitNs, (unsigned long)(clock_now() - task->leverWait));
+    }
+}
+
+/*
+ * holder_task - Coroutine shared by the Barbarian and the Wizard.
+ * Answers its own room type and holds a lever in the treasure room.
+ * @task: The character task.
+ */
+void holder_task(struct CharacterTask *task) {
+    struct DungeonSlot *slot = task->slot;
+    SlotDungeon *dungeon = &slot->dungeon;
+
+    TASK_BEGIN(task);
+    for (;;) {
+        TASK_WAIT(task, WAIT_ROOM);
+        task->seenSeq = __atomic_load_n(&slot->roomSeq, __ATOMIC_ACQUIRE);
+
+        if (slot->roomType == ROOM_ENEMY && task->role == ROLE_BARBARIAN) {
+            // Mirror the monster's health.
+            dungeon->barbarian.attack = dungeon->enemy.health;
+            room_done(task);
+        } else if (slot->roomType == ROOM_BARRIER && task->role == ROLE_WIZARD) {
+            // Decode the barrier straight into the wizard's spell.
+            int length = decode_caesar_cipher(dungeon_slot_barrier(slots, slot), dungeon_slot_wizard(slots, slot),
+                                              SPELL_BUFFER_SIZE);
+            __atomic_store_n(&dungeon->spellLength, length, __ATOMIC_RELEASE);
+            room_done(task);
+        } else if (slot->roomType == ROOM_TREASURE) {
+            deadline_from(&task->deadline, __atomic_load_n(&dungeon->roomDeadline, __ATOMIC_ACQUIRE), TIME_TREASURE_AVAILABLE * NSEC_PER_SEC);
+            task->lever = -1;
+            task->leverWait = 0;
+            // Barbarians reach for Lever One first, Wizards for Lever Two.
+            while (!take_any_lever(task, task->role == ROLE_BARBARIAN ? LEVER_ONE : LEVER_TWO) &&
+                   !deadline_passed(&task->deadline)) {
+                if (task->leverWait == 0) {
+                    task->leverWait = clock_now();
+                }
+                TASK_WAIT(task, WAIT_LEVER);
+            }
+            if (task->lever >= 0) {
+                lever_taken(task);
+                TASK_WAIT(task, WAIT_TREASURE_DONE);
+                lever_release(&dungeon->levers[task->lever], &slot->levers[task->lever]);
+                task->lever = -1;
+                room_done(task);
+            }
+        }
+    }
+    TASK_END(task);
+}
+
+/*
+ * rogue_task - Coroutine for the Rogue.
+ * Bisects the trap angle one engine answer at a time and collects the treasure.
+ * @task: The character task.
+ */
+void rogue_task(struct CharacterTask *task) {
+    struct DungeonSlot *slot = task->slot;
+    SlotDungeon *dungeon = &slot->dungeon;
+
+    TASK_BEGIN(task);
+    for (;;) {
+        TASK_WAIT(task, WAIT_ROOM);
+        task->seenSeq = __atomic_load_n(&slot->roomSeq, __ATOMIC_ACQUIRE);
+
+        if (slot->roomType == ROOM_TRAP) {
+            task->low = 0.0;
+            task->high = MAX_PICK_ANGLE;
+            deadline_from(&task->deadline, __atomic_load_n(&dungeon->roomDeadline, __ATOMIC_ACQUIRE), SECONDS_TO_PICK * NSEC_PER_SEC);
+            for (;;) {
+                // Suspend until the engine has judged the pick currently in place.
+                TASK_WAIT(task, WAIT_TRAP_ANSWER);
+                char direction = dungeon->trap.direction;
+                if (direction == '-' || !dungeon->trap.locked) {
+                    room_done(task);
+                    break;
+                }
+                if (deadline_passed(&task->deadline)) {
+                    break;
+                }
+                if (direction == 'u') {
+                    task->low = dungeon->rogue.pick; // Pick was too low
+                } else {
+                    task->high = dungeon->rogue.pick; // Pick was too high
+                }
+                if (task->high - task->low <= 0.000001) {
+                    break;
+                }
+                dungeon->rogue.pick = task->low + (task->high - task->low) / 2.0;
+                __atomic_store_n(&dungeon->trap.direction, 't', __ATOMIC_RELEASE);
+            }
+        } else if (slot->roomType == ROOM_TREASURE) {
+            deadline_from(&task->deadline, __atomic_load_n(&dungeon->roomDeadline, __ATOMIC_ACQUIRE), TIME_TREASURE_AVAILABLE * NSEC_PER_SEC);
+            for (task->spoils = 0; task->spoils < 4; task->spoils++) {
+                TASK_WAIT(task, WAIT_TREASURE_CHAR);
+                if (dungeon->treasure[task->spoils] == '\0') {
+                    break; // The door closed first.
+                }
+                dungeon->spoils[task->spoils] = dungeon->treasure[task->spoils];
+            }
+            if (task->spoils == 4) {
+                room_done(task);
+            }
+        }
+    }
+    TASK_END(task);
+}
+
+/*
+ * deque_push - Pushes a task on the owner's end of a deque.
+ */
+static void deque_push(struct TaskDeque *deque, struct CharacterTask *task) {
+    pthread_mutex_lock(&deque->lock);
+    deque->items[deque->bottom % deque->capacity] = task;
+    deque->bottom++;
+    pthread_mutex_unlock(&deque->lock);
+}
+
+/*
+ * deque_pop - Pops a task from the owner's end of a deque, or returns NULL if it is empty.
+ */
+static struct CharacterTask *deque_pop(struct TaskDeque *deque) {
+    struct CharacterTask *task = NULL;
+    pthread_mutex_lock(&deque->lock);
+    if (deque->bottom != deque->top) {
+        deque->bottom--;
+        task = deque->items[deque->bottom % deque->capacity];
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return task;
+}
+
+/*
+ * deque_steal - Takes the oldest task from a deque, or returns NULL if it is empty.
+ * Checks emptiness before locking so idle thieves do not contend with the owner.
+ */
+static struct CharacterTask *deque_steal(struct TaskDeque *deque) {
+    struct CharacterTask *task = NULL;
+    if (__atomic_load_n(&deque->bottom, __ATOMIC_RELAXED) == __atomic_load_n(&deque->top, __ATOMIC_RELAXED)) {
+        return NULL;
+    }
+    pthread_mutex_lock(&deque->lock);
+    if (deque->bottom != deque->top) {
+        task = deque->items[deque->top % deque->capacity];
+        deque->top++;
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return task;
+}
+
+/*
+ * steal_task - Tries every other worker once, starting from a random one.
+ * @self: The worker looking for work.
+ */
+static struct CharacterTask *steal_task(struct Worker *self) {
+    if (!stealing || worker_count < 2) {
+        return NULL;
+    }
+    int start = rand_r(&self->seed) % worker_count;
+    for (int i = 0; i < worker_count; i++) {
+        struct Worker *victim = &workers[(start + i) % worker_count];
+        if (victim == self) {
+            continue;
+        }
+        struct CharacterTask *task = deque_steal(&victim->deque);
+        if (task != NULL) {
+            self->steals++;
+            return task;
+        }
+    }
+    return NULL;
+}
+
+/*
+ * run_task - Resumes a task until it next suspends, then lets its owner scan it again.
+ * @worker: The worker running the task (not necessarily its owner).
+ * @task: The character task.
+ */
+static void run_task(struct Worker *worker, struct CharacterTask *task) {
+    if (task->role == ROLE_ROGUE) {
+        rogue_task(task);
+    } else {
+        holder_task(task);
+    }
+    worker->steps++;
+    __atomic_store_n(&task->queued, 0, __ATOMIC_RELEASE);
+}
+
+/*
+ * scan_owned - Queues every owned character whose wait is over.
+ * @worker: The scanning worker.
+ * Returns the number of tasks queued.
+ */
+static int scan_owned(struct Worker *worker) {
+    int pushed = 0;
+    for (int i = 0; i < worker->ownedCount; i++) {
+        struct CharacterTask *task = &worker->owned[i];
+        if (__atomic_load_n(&task->queued, __ATOMIC_ACQUIRE) == 0 && task_ready(task)) {
+            task->queued = 1;
+            deque_push(&worker->deque, task);
+            pushed++;
+        }
+    }
+    return pushed;
+}
+
+/*
+ * worker_main - Worker thread (or process) body.
+ * Scans its own characters, runs everything in its deque, then steals one task from
+ * another worker before scanning again. Naps when there was nothing at all to do.
+ * @arg: Pointer to this worker's struct Worker.
+ */
+void *worker_main(void *arg) {
+    struct Worker *worker = (struct Worker *)arg;
+
+    while (slots->running && exit_flag == 0) {
+        int pushed = scan_owned(worker);
+        int ran = 0;
+        struct CharacterTask *task;
+        while ((task = deque_pop(&worker->deque)) != NULL) {
+            run_task(worker, task);
+            ran++;
+        }
+        if ((task = steal_task(worker)) != NULL) {
+            run_task(worker, task);
+            ran++;
+        }
+        if (pushed == 0 && ran == 0) {
+            clock_sleep(HOST_IDLE_SLEEP * NSEC_PER_USEC);
+        }
+    }
+    return NULL;
+}
+
+/*
+ * error_exit - Prints an error message, unmaps the slots and exits.
+ * @msg: The error message to display.
+ */
+void error_exit(const char *msg) {
+    perror(msg);
+    if (slots != MAP_FAILED) {
+        munmap(slots, slots_size);
+        slots = MAP_FAILED;
+    }
+    exit(EXIT_FAILURE);
+}
+
+/*
+ * main - Attaches to /DungeonSlots, spreads the characters of every slot over the
+ * workers, runs until the engine finishes or SIGINT arrives, and prints a report.
+ */
+int main(int argc, char *argv[]) {
+    int threads = 1;
+    bool per_process = false;
+    int option;
+    while ((option = getopt(argc, argv, "w:p")) != -1) {
+        if (option == 'w') {
+            threads = atoi(optarg) > 0 ? atoi(optarg) : 1;
+        } else if (option == 'p') {
+            per_process = true;
+        } else {
+            fprintf(stderr, "Usage: %s [-w worker_threads] [-p]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    printf("[HOST] Process started. PID: %d\n", getpid());
+
+    // --- 1. Connect to the Slots ---
+    int fd = shm_open(DUNGEON_SLOTS_SHM_NAME, O_RDWR, 0666);
+    if (fd == -1) {
+        error_exit("HOST: shm_open failed");
+    }
+    struct stat info;
+    if (fstat(fd, &info) == -1) {
+        close(fd);
+        error_exit("HOST: fstat failed");
+    }
+    slots_size = (size_t)info.st_size;
+    slots = (struct DungeonSlots *)mmap(NULL, slots_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd); // The mapping stays valid after the descriptor is closed.
+    if (slots == MAP_FAILED) {
+        error_exit("HOST: mmap failed");
+    }
+    if (slots_size >= sizeof(struct DungeonSlots) && slots->layout != DUNGEON_SLOTS_LAYOUT) {
+        fprintf(stderr, "HOST: /DungeonSlots uses another slot layout; rebuild master and host alike.\n");
+        munmap(slots, slots_size);
+        return EXIT_FAILURE;
+    }
+    if (slots_size < sizeof(struct DungeonSlots) || slots->count < 1 ||
+        slots_size < dungeon_slots_size(slots->count)) {
+        fprintf(stderr, "HOST: /DungeonSlots holds no games or is smaller than its slot count.\n");
+        munmap(slots, slots_size);
+        return EXIT_FAILURE;
+    }
+    stat_add(&slots->host.hostsAttached, 1);
+    printf("[HOST] Connected to %d slots.\n", slots->count);
+
+    // --- 2. Set up SIGINT ---
+    struct sigaction sa_sigint;
+    memset(&sa_sigint, 0, sizeof(sa_sigint));
+    sa_sigint.sa_handler = sigint_handler;
+    if (sigaction(SIGINT, &sa_sigint, NULL) == -1) {
+        perror("HOST: sigaction failed for SIGINT");
+    }
+
+    // --- 3. Create the Characters and Workers ---
+    // The three characters of slot s are tasks 3s, 3s+1 and 3s+2. Each worker owns a
+    // contiguous range of whole slots, so a game's state normally stays in one cache and
+    // only moves when a task is stolen. In -p mode every character gets a worker of its own.
+    int task_count = slots->count * 3;
+    worker_count = per_process ? task_count : (threads < slots->count ? threads : slots->count);
+    if (worker_count < 1) {
+        worker_count = 1;
+    }
+    size_t worker_total = (size_t)worker_count; // Known positive here, for the allocations below
+    stealing = !per_process;
+    struct CharacterTask *tasks = shared_calloc((size_t)task_count * sizeof(struct CharacterTask));
+    struct CharacterTask **items = shared_calloc((size_t)task_count * sizeof(struct CharacterTask *));
+    workers = shared_calloc(worker_total * sizeof(struct Worker));
+    if (tasks == NULL || items == NULL || workers == NULL) {
+        error_exit("HOST: mmap failed for workers");
+    }
+    for (int i = 0; i < task_count; i++) {
+        struct CharacterTask *task = &tasks[i];
+        task->role = (enum CharacterRole)(i % ROLE_COUNT);
+        task->slot = &slots->slots[i / ROLE_COUNT];
+        task->seenSeq = __atomic_load_n(&task->slot->roomSeq, __ATOMIC_ACQUIRE);
+        task->wait = WAIT_ROOM;
+        task->lever = -1;
+    }
+    for (int w = 0; w < worker_count; w++) {
+        struct Worker *worker = &workers[w];
+        int first = per_process ? w : 3 * (int)((long)w * slots->count / worker_count);
+        int last = per_process ? w + 1 : 3 * (int)((long)(w + 1) * slots->count / worker_count);
+        worker->owned = &tasks[first];
+        worker->ownedCount = last - first;
+        worker->seed = (unsigned int)(getpid() + w);
+        worker->deque.items = &items[first];
+        worker->deque.capacity = (unsigned long)(last - first);
+        pthread_mutexattr_t attr;
+        pthread_mutexattr_init(&attr);
+        pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+        pthread_mutex_init(&worker->deque.lock, &attr);
+        pthread_mutexattr_destroy(&attr);
+    }
+
+    // --- 4. Run the Workers ---
+    long long start = clock_now();
+    pid_t *children = NULL;
+    if (per_process) {
+        children = calloc(worker_total, sizeof(pid_t));
+        if (children == NULL) {
+            error_exit("HOST: calloc failed");
+        }
+        for (int w = 0; w < worker_count; w++) {
+            children[w] = fork();
+            if (children[w] < 0) {
+                perror("HOST: fork failed");
+                exit_flag = 1;
+                break;
+            } else if (children[w] == 0) {
+                worker_main(&workers[w]);
+                _exit(EXIT_SUCCESS);
+            }
+        }
+        printf("[HOST] %d characters running as %d processes.\n", task_count, worker_count);
+        for (int w = 0; w < worker_count; w++) {
+            int status = 0;
+            if (children[w] > 0 && waitpid(children[w], &status, 0) > 0 && WIFSIGNALED(status)) {
+                stat_add(&slots->host.workersCrashed, 1);
+                printf("[HOST] Character process %d was killed by signal %d.\n", children[w], WTERMSIG(status));
+            }
+        }
+        free(children);
+    } else {
+        for (int w = 0; w < worker_count; w++) {
+            if (pthread_create(&workers[w].thread, NULL, worker_main, &workers[w]) != 0) {
+                error_exit("HOST: pthread_create failed");
+            }
+        }
+        printf("[HOST] %d characters running on %d worker threads.\n", task_count, worker_count);
+        for (int w = 0; w < worker_count; w++) {
+            pthread_join(workers[w].thread, NULL);
+        }
+    }
+    double elapsed = (double)(clock_now() - start) / NSEC_PER_SEC;
+
+    // --- 5. Report and Clean Up ---
+    unsigned long rooms[ROLE_COUNT] = { 0, 0, 0 };
+    for (int i = 0; i < task_count; i++) {
+        rooms[tasks[i].role] += tasks[i].rooms;
+    }
+    unsigned long steps = 0, steals = 0;
+    for (int w = 0; w < worker_count; w++) {
+        steps += workers[w].steps;
+        steals += workers[w].steals;
+    }
+    printf("[HOST] Mode: %s.\n", per_process ? "one process per character" : "work-stealing thread pool");
+    printf("[HOST] Rooms completed in %.2f s: barbarian %lu, wizard %lu, rogue %lu.\n",
+           elapsed, rooms[ROLE_BARBARIAN], rooms[ROLE_WIZARD], rooms[ROLE_ROGUE]);
+    printf("[HOST] Tasks run: %lu (%.0f/s), stolen: %lu.\n", steps, elapsed > 0 ? steps / elapsed : 0.0, steals);
+    histogram_print("[HOST] Room latency (all hosts)", &slots->host.latency);
+
+    munmap(tasks, (size_t)task_count * sizeof(struct CharacterTask));
+    munmap(items, (size_t)task_count * sizeof(struct CharacterTask *));
+    munmap(workers, (size_t)worker_count * sizeof(struct Worker));
+    if (munmap(slots, slots_size) == -1) {
+        perror("HOST: munmap failed");
+    }
+    printf("[HOST] Cleanup complete. Exiting.\n");
+    return EXIT_SUCCESS;
+}
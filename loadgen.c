@@ -0,0 +1,584 @@
+/*
+ * loadgen.c - Open-loop load generator for one character process.
+ * game.c plays one room after another, each as soon as the last one is over, so a slow room
+ * simply delays the rooms after it and that delay never shows in any measurement
+ * (coordinated omission). This stand-in engine instead decides up front when each room
+ * arrives, at a fixed rate or as a Poisson process, and measures every room's latency from
+ * that intended arrival time. A room that has to wait for the previous one to finish is charged
+ * for the wait, just as a player queued behind it would be.
+ *
+ * It speaks the real /DungeonMem protocol to a real ./barbarian, ./wizard or ./rogue: it
+ * creates the shared memory, levers and eventfds as game.c does, publishes each room the way
+ * engine.c does (roomSeq, roomType, roomDeadline, futex wake, eventfd, queued realtime signal
+ * or plain signal) and waits for the answer:
+ *
+ *   barbarian - enemy rooms, answered when answerSeq reaches the room
+ *   wizard    - barrier rooms drawn by engine.o, answered when answerSeq reaches the room
+ *   rogue     - trap rooms, judged like engine.c does, answered when the trap unlocks
+ *
+ * One game only has room for one open room, so arrivals that find the character busy queue
+ * here. Each rate of the sweep runs for the given duration; arrivals still queued at twice
+ * that are counted as unserved, with the time they had waited. A rate is sustainable when no
+ * room failed or went unserved and the p99 latency stayed within the SLO.
+ *
+ * Timing: the generator sleeps until LOADGEN_SPIN before each arrival and yields for the rest,
+ * so waking up late does not show up as latency. Answers are polled with sched_yield, and trap
+ * picks are awaited on pickSeq's futex as engine.c does, since the Rogue spins while it waits
+ * for a verdict. While a room is open the generator therefore keeps a core busy.
+ *
+ * Noisy neighbours: each -n spec (see dungeon_noise.h) adds background interference, e.g.
+ * -n cpu@0 -n stream:2 -n thrash. Each rate is then run twice, first quiet and then with the
+ * interference running, and the report shows how the latency percentiles and the share of rooms
+ * answered in time degrade. -p pins the generator and the character to one CPU, so the noise
+ * can be aimed at it or kept off it; noise workers without a CPU list inherit that pinning.
+ *
+ * Usage: ./loadgen [-c barbarian|wizard|rogue] [-r rate,rate,...] [-d seconds] [-a poisson|constant]
+ *                  [-l slo_us] [-S seed] [-n kind[:workers][@cpu,...]]... [-p cpu]
+ */
+
+// Include necessary headers for system calls and standard libraries.
+#define _XOPEN_SOURCE 700       // Ensure POSIX features are available
+#define _POSIX_C_SOURCE 200809L // Ensure POSIX.1-2008 compliance
+#define _DEFAULT_SOURCE         // For syscall (futex_wake)
+#define _GNU_SOURCE             // For sched_setaffinity (noise and -p pinning)
+
+#include <stdio.h>      // For printf, perror
+#include <stdlib.h>     // For exit, atoi, strtod
+#include <unistd.h>     // For fork, execv, getpid, getopt
+#include <sys/mman.h>   // For shared memory functions (shm_open, mmap, munmap, shm_unlink)
+#include <sys/stat.h>   // For mode constants
+#include <sys/wait.h>   // For waitpid
+#include <sys/eventfd.h> // For eventfd (eventfd wait strategy, see character.h)
+#include <fcntl.h>      // For O_* constants
+#include <semaphore.h>  // For sem_open, sem_close, sem_unlink
+#include <signal.h>     // For sigaction, kill, sigqueue
+#include <sched.h>      // For sched_yield
+#include <stdbool.h>    // For bool type
+#include <string.h>     // For memset, memcmp, strcmp, strtok
+#include <math.h>       // For log
+#include <errno.h>      // For errno
+
+// Include custom header files for shared resources and settings.
+#include "dungeon_info.h"      // Defines shared memory/semaphore names and struct layout
+#include "dungeon_settings.h"  // Defines signals and game parameters
+#include "dungeon_clock.h"     // Monotonic time
+#include "dungeon_futex.h"     // Wakes characters that wait on roomSeq
+#include "dungeon_signals.h"   // Realtime room signals
+#include "dungeon_slots.h"     // For enum RoomType
+#include "dungeon_histogram.h" // Latency histograms for the report
+#include "engine.h"            // Draws barriers and traps like a real game
+#include "dungeon_noise.h"     // Background interference (-n)
+
+#define MAX_RATES (32)
+#define MAX_NOISE (8)
+
+// What one rate of the sweep measured.
+struct LoadRun {
+    double rate;               // Arrivals per second
+    unsigned long issued;      // Rooms announced to the character
+    unsigned long answered;    // Rooms answered correctly before they closed
+    unsigned long failed;      // Rooms that closed without a correct answer
+    unsigned long unserved;    // Arrivals still queued when the run was cut off
+    double elapsed;            // Seconds from the first arrival to the last answer
+    struct LatencyHistogram latency; // Intended arrival to answer, unserved rooms included
+    struct LatencyHistogram service; // Announcement to answer
+};
+
+// --- Global Variables ---
+struct Dungeon *dungeon_ptr = MAP_FAILED; // The shared Dungeon
+struct DungeonEngine engine;              // Random draws for rooms and arrivals
+enum CharacterRole target = ROLE_BARBARIAN; // The character under load
+pid_t character_pid = -1;                 // Its process
+bool poisson = true;                      // Poisson arrivals (true) or a constant rate (false)
+struct Noise noise;                       // Interference workers while a noisy run is going
+
+// Flag to stop the sweep, set by the SIGINT handler.
+volatile sig_atomic_t exit_flag = 0;
+
+// --- Function Definitions ---
+
+/*
+ * sigint_handler - Handles the SIGINT signal (Ctrl+C) for graceful exit.
+ * @signum: The signal number (SIGINT).
+ */
+void sigint_handler(int signum) {
+    (void)signum;
+    exit_flag = 1;
+}
+
+/*
+ * next_gap - Returns the time from one arrival to the next, in ns.
+ * Exponentially distributed with mean 1/@rate for Poisson arrivals, exactly 1/@rate otherwise.
+ * @rate: Arrivals per second.
+ */
+static long long next_gap(double rate) {
+    double mean = NSEC_PER_SEC / rate;
+    if (!poisson) {
+        return (long long)mean;
+    }
+    double uniform = ((double)engine_random(&engine) + 1.0) / 4294967296.0; // In (0, 1]
+    return (long long)(-log(uniform) * mean);
+}
+
+/*
+ * wait_until - Waits for an absolute CLOCK_MONOTONIC time in ns.
+ * Sleeps until LOADGEN_SPIN before it, then yields until it has come.
+ */
+static void wait_until(long long at) {
+    long long wake_at = at - LOADGEN_SPIN * NSEC_PER_USEC;
+    struct timespec wake;
+    wake.tv_sec = wake_at / NSEC_PER_SEC;
+    wake.tv_nsec = wake_at % NSEC_PER_SEC;
+    while (clock_now() < wake_at &&
+           clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wake, NULL) == EINTR && exit_flag == 0) {
+        // Interrupted by a signal other than SIGINT: keep sleeping.
+    }
+    while (clock_now() < at && exit_flag == 0) {
+        sched_yield();
+    }
+}
+
+/*
+ * announce - Opens a room and tells the character about it, as engine.c does.
+ * @type: The room's enum RoomType.
+ * @budget_ns: How long the room stays open.
+ * Returns the room's sequence number.
+ */
+static unsigned int announce(int type, long long budget_ns) {
+    __atomic_store_n(&dungeon_ptr->roomDeadline, clock_now() + budget_ns, __ATOMIC_RELAXED);
+    __atomic_store_n(&dungeon_ptr->roomType, type, __ATOMIC_RELAXED);
+    unsigned int seq = __atomic_add_fetch(&dungeon_ptr->roomSeq, 1, __ATOMIC_RELEASE);
+    futex_wake(&dungeon_ptr->roomSeq);
+
+    int event_fd = dungeon_ptr->eventFds[target];
+    if (event_fd > 0) {
+        uint64_t one = 1;
+        if (write(event_fd, &one, sizeof(one)) == -1) {
+            perror("LOADGEN: eventfd write failed");
+        }
+    }
+    if (DUNGEON_SIGNAL_PAYLOADS) {
+        sigqueue(character_pid, DUNGEON_RT_SIGNAL, room_signal_encode(seq, type, 0));
+    } else {
+        kill(character_pid, DUNGEON_SIGNAL);
+    }
+    return seq;
+}
+
+/*
+ * await_answer - Yields until the character has answered room @seq or the room closes.
+ * Returns true if it answered.
+ */
+static bool await_answer(unsigned int seq) {
+    long long closes = __atomic_load_n(&dungeon_ptr->roomDeadline, __ATOMIC_RELAXED);
+    while (__atomic_load_n(&dungeon_ptr->answerSeq, __ATOMIC_ACQUIRE) != seq) {
+        if (clock_now_coarse() >= closes || exit_flag) {
+            return false;
+        }
+        sched_yield();
+    }
+    return true;
+}
+
+/*
+ * judge_pick - Answers the Rogue's current pick, with engine.c's compare-and-swap, so a verdict
+ * on a pick the rogue has just replaced is dropped.
+ * @trap: The trap's angle.
+ * Returns true if the trap unlocked.
+ */
+static bool judge_pick(float trap) {
+    char seen = __atomic_load_n(&dungeon_ptr->trap.direction, __ATOMIC_ACQUIRE);
+    float pick = dungeon_ptr->rogue.pick;
+    char verdict = '-';
+    if (pick < trap - LOCK_THRESHOLD) {
+        verdict = 'u';
+    } else if (pick > trap + LOCK_THRESHOLD) {
+        verdict = 'd';
+    }
+    if (!__atomic_compare_exchange_n(&dungeon_ptr->trap.direction, &seen, verdict, false, __ATOMIC_ACQ_REL,
+                                     __ATOMIC_ACQUIRE)) {
+        return false;
+    }
+    if (verdict == '-') {
+        dungeon_ptr->trap.locked = false;
+        return true;
+    }
+    return false;
+}
+
+/*
+ * play_trap - Locks a trap, announces it and judges every pick until it unlocks or closes.
+ * Returns true if the trap unlocked in time.
+ */
+static bool play_trap(void) {
+    float trap = engine_draw_trap(&engine);
+    dungeon_ptr->trap.direction = 'w';
+    dungeon_ptr->trap.locked = true;
+    unsigned int picks = __atomic_load_n(&dungeon_ptr->pickSeq, __ATOMIC_ACQUIRE);
+    announce(ROOM_TRAP, SECONDS_TO_PICK * NSEC_PER_SEC);
+    long long closes = __atomic_load_n(&dungeon_ptr->roomDeadline, __ATOMIC_RELAXED);
+
+    // The pick in place when the trap locked is judged straight away, as engine.c does, and
+    // every later one as soon as the rogue bumps pickSeq.
+    bool unlocked = judge_pick(trap);
+    while (!unlocked && exit_flag == 0) {
+        long long left = closes - clock_now();
+        if (left <= 0) {
+            break;
+        }
+        long long tick = TIME_BETWEEN_ROGUE_TICKS * NSEC_PER_USEC;
+        futex_wait(&dungeon_ptr->pickSeq, picks, left < tick ? left : tick);
+        unsigned int current = __atomic_load_n(&dungeon_ptr->pickSeq, __ATOMIC_ACQUIRE);
+        if (current != picks || dungeon_ptr->trap.direction == 't') {
+            picks = current;
+            unlocked = judge_pick(trap);
+        }
+    }
+    if (!unlocked) {
+        // Release the rogue from its search.
+        dungeon_ptr->trap.direction = '-';
+        dungeon_ptr->trap.locked = false;
+    }
+    return unlocked;
+}
+
+/*
+ * play_room - Plays one room for the character under load.
+ * Returns true if it was answered correctly in time.
+ */
+static bool play_room(void) {
+    if (target == ROLE_BARBARIAN) {
+        dungeon_ptr->enemy.health = (int)(engine_random(&engine) >> 1);
+        unsigned int seq = announce(ROOM_ENEMY, SECONDS_TO_ATTACK * NSEC_PER_SEC);
+        return await_answer(seq) && dungeon_ptr->barbarian.attack == dungeon_ptr->enemy.health;
+    }
+    if (target == ROLE_WIZARD) {
+        engine_draw_barrier(&engine, dungeon_ptr->barrier.spell);
+        dungeon_ptr->wizard.spell[0] = '\0';
+        __atomic_store_n(&dungeon_ptr->spellLength, 0, __ATOMIC_RELAXED);
+        unsigned int seq = announce(ROOM_BARRIER, SECONDS_TO_GUESS_BARRIER * NSEC_PER_SEC);
+        if (!await_answer(seq)) {
+            return false;
+        }
+        int length = __atomic_load_n(&dungeon_ptr->spellLength, __ATOMIC_ACQUIRE);
+        return length > 0 && (size_t)length == strlen(engine.barrierAnswer) &&
+               memcmp(dungeon_ptr->wizard.spell, engine.barrierAnswer, length) == 0;
+    }
+    return play_trap();
+}
+
+/*
+ * run_rate - Offers rooms at run->rate for @duration_ns and records what happened.
+ * @run: The run; rate set by the caller, everything else filled in here.
+ * @duration_ns: How long arrivals keep coming.
+ */
+static void run_rate(struct LoadRun *run, long long duration_ns) {
+    long long start = clock_now();
+    long long stop_arrivals = start + duration_ns;
+    long long cut_off = start + 2 * duration_ns; // Queued rooms not started by then go unserved
+    long long intended = start;
+    long long last_answer = start;
+
+    while (intended < stop_arrivals && exit_flag == 0) {
+        long long now = clock_now();
+        if (now >= cut_off) {
+            break;
+        }
+        if (intended > now) {
+            wait_until(intended); // The character is idle until the next arrival.
+        }
+        long long sent = clock_now();
+        run->issued++;
+        bool passed = play_room();
+        long long done = clock_now();
+        if (passed) {
+            run->answered++;
+        } else {
+            run->failed++;
+        }
+        histogram_record(&run->latency, done - intended);
+        histogram_record(&run->service, done - sent);
+        last_answer = done;
+        intended += next_gap(run->rate);
+        if (kill(character_pid, 0) == -1) {
+            fprintf(stderr, "LOADGEN: the character process is gone.\n");
+            exit_flag = 1;
+        }
+    }
+    // Arrivals that were still queued count with the time they had waited so far.
+    long long now = clock_now();
+    for (; intended < stop_arrivals && exit_flag == 0; intended += next_gap(run->rate)) {
+        run->unserved++;
+        histogram_record(&run->latency, now - intended);
+    }
+    run->elapsed = (double)(last_answer - start) / NSEC_PER_SEC;
+}
+
+/*
+ * sustainable - Whether a run kept up: nothing failed or queued up, and p99 within @slo_ns.
+ */
+static bool sustainable(const struct LoadRun *run, long long slo_ns) {
+    return run->issued > 0 && run->failed == 0 && run->unserved == 0 &&
+           histogram_percentile(&run->latency, 99.0) <= slo_ns;
+}
+
+/*
+ * success_rate - Percentage of a run's arrivals that were answered correctly in time.
+ */
+static double success_rate(const struct LoadRun *run) {
+    unsigned long offered = run->issued + run->unserved;
+    return offered > 0 ? 100.0 * run->answered / offered : 0.0;
+}
+
+/*
+ * print_run - Reports one run of the sweep.
+ * @label: "" for a plain sweep, "quiet" or "noisy" when comparing.
+ */
+static void print_run(const struct LoadRun *run, const char *label, bool kept_up) {
+    printf("[LOADGEN] %.0f/s%s%s: issued %lu, answered %lu, failed %lu, unserved %lu; %.1f rooms/s answered. %s\n",
+           run->rate, label[0] ? " " : "", label, run->issued, run->answered, run->failed, run->unserved,
+           run->elapsed > 0 ? run->answered / run->elapsed : 0.0, kept_up ? "Sustainable." : "Not sustainable.");
+    histogram_print("[LOADGEN]   Latency from intended arrival", &run->latency);
+    histogram_print("[LOADGEN]   Service time", &run->service);
+}
+
+/*
+ * print_degradation - Compares a noisy run with the quiet run at the same rate.
+ */
+static void print_degradation(const struct LoadRun *quiet, const struct LoadRun *noisy) {
+    printf("[LOADGEN] %.0f/s under noise:", quiet->rate);
+    const double percentiles[] = {50.0, 99.0, 99.9};
+    const char *names[] = {"p50", "p99", "p99.9"};
+    for (int i = 0; i < 3; i++) {
+        long long before = histogram_percentile(&quiet->latency, percentiles[i]);
+        long long after = histogram_percentile(&noisy->latency, percentiles[i]);
+        printf(" %s %.1f -> %.1f us (x%.2f),", names[i], before / 1000.0, after / 1000.0,
+               before > 0 ? (double)after / before : 0.0);
+    }
+    printf(" answered in time %.2f%% -> %.2f%%.\n", success_rate(quiet), success_rate(noisy));
+}
+
+/*
+ * spawn_character - Starts the character under load, as game.c does.
+ * Returns its PID, or -1 if it could not be started.
+ */
+static pid_t spawn_character(const char *path) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        char *args[] = {(char *)path, NULL};
+        execv(path, args);
+        perror("LOADGEN: execv failed");
+        _exit(EXIT_FAILURE);
+    }
+    return pid;
+}
+
+/*
+ * cleanup - Stops the character and removes the shared memory, levers and eventfds.
+ */
+static void cleanup(sem_t *lever1, sem_t *lever2) {
+    noise_stop(&noise);
+    if (dungeon_ptr != MAP_FAILED) {
+        dungeon_ptr->running = false;
+        futex_wake(&dungeon_ptr->roomSeq);
+    }
+    if (character_pid > 0) {
+        kill(character_pid, SIGINT);
+        waitpid(character_pid, NULL, 0);
+    }
+    if (dungeon_ptr != MAP_FAILED) {
+        for (int i = 0; i < ROLE_COUNT; i++) {
+            if (dungeon_ptr->eventFds[i] > 0) close(dungeon_ptr->eventFds[i]);
+        }
+        munmap(dungeon_ptr, sizeof(struct Dungeon));
+    }
+    shm_unlink(dungeon_shm_name);
+    if (lever1 != SEM_FAILED) sem_close(lever1);
+    if (lever2 != SEM_FAILED) sem_close(lever2);
+    sem_unlink(dungeon_lever_one);
+    sem_unlink(dungeon_lever_two);
+}
+
+/*
+ * main - Sets up the dungeon, starts the character, sweeps the rates and reports.
+ */
+int main(int argc, char *argv[]) {
+    const char *character = "barbarian";
+    char rate_list[256] = "50,100,200,500,1000,2000";
+    double duration = 2.0;
+    long long slo = LOADGEN_SLO;
+    uint64_t seed = (uint64_t)getpid();
+    struct NoiseSpec noise_specs[MAX_NOISE];
+    int noise_count = 0;
+    int pin_cpu = -1;
+    int option;
+    while ((option = getopt(argc, argv, "c:r:d:a:l:S:n:p:")) != -1) {
+        switch (option) {
+        case 'c': character = optarg; break;
+        case 'r': snprintf(rate_list, sizeof(rate_list), "%s", optarg); break;
+        case 'd': duration = strtod(optarg, NULL); break;
+        case 'a': poisson = strcmp(optarg, "constant") != 0; break;
+        case 'l': slo = atoi(optarg); break;
+        case 'S': seed = (uint64_t)strtoull(optarg, NULL, 10); break;
+        case 'n':
+            if (noise_count == MAX_NOISE) {
+                fprintf(stderr, "LOADGEN: at most %d noise specs.\n", MAX_NOISE);
+                return EXIT_FAILURE;
+            }
+            if (noise_parse(optarg, &noise_specs[noise_count]) == -1) {
+                return EXIT_FAILURE;
+            }
+            noise_count++;
+            break;
+        case 'p': pin_cpu = atoi(optarg); break;
+        default:
+            fprintf(stderr, "Usage: %s [-c barbarian|wizard|rogue] [-r rate,rate,...] [-d seconds] "
+                            "[-a poisson|constant] [-l slo_us] [-S seed] [-n kind[:workers][@cpu,...]]... "
+                            "[-p cpu]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    const char *path;
+    if (strcmp(character, "barbarian") == 0) {
+        target = ROLE_BARBARIAN;
+        path = "./barbarian";
+    } else if (strcmp(character, "wizard") == 0) {
+        target = ROLE_WIZARD;
+        path = "./wizard";
+    } else if (strcmp(character, "rogue") == 0) {
+        target = ROLE_ROGUE;
+        path = "./rogue";
+    } else {
+        fprintf(stderr, "LOADGEN: the character must be barbarian, wizard or rogue.\n");
+        return EXIT_FAILURE;
+    }
+    struct LoadRun runs[MAX_RATES];
+    int run_count = 0;
+    for (char *token = strtok(rate_list, ","); token != NULL && run_count < MAX_RATES; token = strtok(NULL, ",")) {
+        memset(&runs[run_count], 0, sizeof(runs[run_count]));
+        runs[run_count].rate = strtod(token, NULL);
+        if (runs[run_count].rate <= 0.0) {
+            fprintf(stderr, "LOADGEN: rates must be positive.\n");
+            return EXIT_FAILURE;
+        }
+        run_count++;
+    }
+    if (run_count == 0 || duration <= 0.0 || slo <= 0) {
+        fprintf(stderr, "LOADGEN: give at least one rate, a positive duration and a positive SLO.\n");
+        return EXIT_FAILURE;
+    }
+    printf("[LOADGEN] Process started. PID: %d\n", getpid());
+    if (pin_cpu >= 0 && noise_pin(pin_cpu) == -1) {
+        perror("LOADGEN: sched_setaffinity failed");
+        return EXIT_FAILURE;
+    }
+    engine_init(&engine, 0, 0, 0, seed);
+
+    // --- 1. Shared Memory, Levers and eventfds, as in game.c ---
+    sem_t *lever1 = SEM_FAILED, *lever2 = SEM_FAILED;
+    int shm_fd = shm_open(dungeon_shm_name, O_CREAT | O_RDWR, 0666);
+    if (shm_fd == -1 || ftruncate(shm_fd, sizeof(struct Dungeon)) == -1) {
+        perror("LOADGEN: shared memory setup failed");
+        cleanup(lever1, lever2);
+        return EXIT_FAILURE;
+    }
+    dungeon_ptr = (struct Dungeon *)mmap(NULL, sizeof(struct Dungeon), PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd, 0);
+    close(shm_fd); // The mapping stays valid after the descriptor is closed.
+    if (dungeon_ptr == MAP_FAILED) {
+        perror("LOADGEN: mmap failed");
+        cleanup(lever1, lever2);
+        return EXIT_FAILURE;
+    }
+    memset(dungeon_ptr, 0, sizeof(struct Dungeon));
+    dungeon_ptr->running = true;
+    dungeon_ptr->dungeonPID = getpid();
+    for (int i = 0; i < ROLE_COUNT; i++) {
+        int event_fd = eventfd(0, EFD_NONBLOCK);
+        dungeon_ptr->eventFds[i] = (event_fd > 0) ? event_fd : 0;
+    }
+    sem_unlink(dungeon_lever_one);
+    sem_unlink(dungeon_lever_two);
+    lever1 = sem_open(dungeon_lever_one, O_CREAT, 0666, 1);
+    lever2 = sem_open(dungeon_lever_two, O_CREAT, 0666, 1);
+    if (lever1 == SEM_FAILED || lever2 == SEM_FAILED) {
+        perror("LOADGEN: sem_open failed");
+        cleanup(lever1, lever2);
+        return EXIT_FAILURE;
+    }
+
+    struct sigaction sa_sigint;
+    memset(&sa_sigint, 0, sizeof(sa_sigint));
+    sa_sigint.sa_handler = sigint_handler;
+    if (sigaction(SIGINT, &sa_sigint, NULL) == -1) {
+        perror("LOADGEN: sigaction failed for SIGINT");
+    }
+
+    // --- 2. Start the Character (it inherits the -p pinning) ---
+    character_pid = spawn_character(path);
+    if (character_pid < 0) {
+        perror("LOADGEN: fork failed");
+        cleanup(lever1, lever2);
+        return EXIT_FAILURE;
+    }
+    clock_sleep(NSEC_PER_SEC / 10); // Give it a moment to attach, as game.c does.
+    printf("[LOADGEN] Offering %s rooms to %s (PID %d), %.1f s per rate, SLO p99 <= %.1f ms.\n",
+           poisson ? "Poisson" : "constant-rate", character, character_pid, duration, slo / 1000.0);
+    if (pin_cpu >= 0) {
+        printf("[LOADGEN] Generator and %s pinned to CPU %d.\n", character, pin_cpu);
+    }
+    for (int i = 0; i < noise_count; i++) {
+        printf("[LOADGEN] Noise: %d %s worker(s)", noise_specs[i].workers, noise_kind_name(noise_specs[i].kind));
+        for (int c = 0; c < noise_specs[i].cpuCount; c++) {
+            printf("%s%d", c == 0 ? " on CPU " : ",", noise_specs[i].cpus[c]);
+        }
+        printf(".\n");
+    }
+
+    // --- 3. Sweep the Rates, Each Quiet and Then Noisy When Noise Was Asked For ---
+    double best = 0.0, best_noisy = 0.0;
+    for (int r = 0; r < run_count && exit_flag == 0; r++) {
+        struct LoadRun *run = &runs[r];
+        run_rate(run, (long long)(duration * NSEC_PER_SEC));
+        bool kept_up = sustainable(run, slo * NSEC_PER_USEC);
+        print_run(run, noise_count > 0 ? "quiet" : "", kept_up);
+        if (kept_up && run->rate > best) {
+            best = run->rate;
+        }
+        if (noise_count == 0 || exit_flag) {
+            continue;
+        }
+        struct LoadRun noisy;
+        memset(&noisy, 0, sizeof(noisy));
+        noisy.rate = run->rate;
+        if (noise_start(&noise, noise_specs, noise_count) == -1) {
+            cleanup(lever1, lever2);
+            return EXIT_FAILURE;
+        }
+        clock_sleep(NSEC_PER_SEC / 2); // Let the workers fault their buffers in first.
+        run_rate(&noisy, (long long)(duration * NSEC_PER_SEC));
+        noise_stop(&noise);
+        kept_up = sustainable(&noisy, slo * NSEC_PER_USEC);
+        print_run(&noisy, "noisy", kept_up);
+        print_degradation(run, &noisy);
+        if (kept_up && noisy.rate > best_noisy) {
+            best_noisy = noisy.rate;
+        }
+    }
+    if (best > 0.0) {
+        printf("[LOADGEN] Highest sustainable rate for the %s%s: %.0f rooms/s.\n", character,
+               noise_count > 0 ? " (quiet)" : "", best);
+    } else {
+        printf("[LOADGEN] The %s sustained none of the rates offered%s.\n", character,
+               noise_count > 0 ? " (quiet)" : "");
+    }
+    if (noise_count > 0 && best_noisy > 0.0) {
+        printf("[LOADGEN] Highest sustainable rate for the %s (noisy): %.0f rooms/s.\n", character, best_noisy);
+    } else if (noise_count > 0) {
+        printf("[LOADGEN] The %s sustained none of the rates offered (noisy).\n", character);
+    }
+
+    // --- 4. Clean Up ---
+    cleanup(lever1, lever2);
+    printf("[LOADGEN] Cleanup complete. Exiting.\n");
+    return EXIT_SUCCESS;
+}
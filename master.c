@@ -0,0 +1,749 @@
+/*
+ * master.c - Dungeon Master for many games at once.
+ * Creates /DungeonSlots (see dungeon_slots.h), runs one game in each slot and judges the
+ * answers of the characters hosted by ./host. A single dispatcher thread serves every game.
+ *
+ * Scheduling: each game always has exactly one job, either opening its next room or checking
+ * the open room. Jobs wait in a timer heap until their release time and are then run in
+ * earliest-deadline-first order. A room check's deadline is the room's own closing time, so
+ * a 2 second enemy room is served before a 10 second treasure room; a trap check's deadline
+ * is one TIME_BETWEEN_ROGUE_TICKS after its release, because each pick must be judged within
+ * a tick. Jobs that run later than their deadline are counted in slots->stats.
+ *
+ * Admission control: every admitted game needs one check per MASTER_POLL_INTERVAL. The
+ * dispatcher measures what a check costs and only admits another game while the admitted
+ * games fit under MASTER_MAX_UTILIZATION (the EDF utilization bound). Other games wait for
+ * a running game to finish and are rejected after MASTER_ADMISSION_TIMEOUT.
+ *
+ * With a results directory set (DUNGEON_RESULTS, see dungeon_results.h), every enemy, barrier
+ * and trap room is appended to the columnar results log as it closes. With a spell corpus set
+ * (DUNGEON_CORPUS, see dungeon_corpus.h), every game draws its barrier phrases from it.
+ *
+ * Usage: ./master [-s slots] [-g games] [-r rounds] [-S seed]
+ */
+
+// Include necessary headers for system calls and standard libraries.
+#define _XOPEN_SOURCE 700       // Ensure POSIX features are available
+#define _POSIX_C_SOURCE 200809L // Ensure POSIX.1-2008 compliance
+
+#include <stdio.h>      // For printf, perror
+#include <stdlib.h>     // For exit, atoi, calloc, rand_r
+#include <unistd.h>     // For getpid, getopt, ftruncate
+#include <sys/mman.h>   // For shared memory functions (shm_open, mmap, munmap, shm_unlink)
+#include <sys/stat.h>   // For mode constants
+#include <fcntl.h>      // For O_* constants
+#include <signal.h>     // For sigaction
+#include <semaphore.h>  // For sem_init, sem_getvalue, sem_post
+#include <stdbool.h>    // For bool type
+#include <string.h>     // For memset, memcmp, strlen
+#include <stdint.h>     // For uintptr_t
+
+// Include custom header files for shared resources and settings.
+#include "dungeon_info.h"      // Defines the Dungeon struct layout
+#include "dungeon_settings.h"  // Defines game parameters
+#include "dungeon_slots.h"     // Defines the multi-game slot layout and protocol
+#include "dungeon_levers.h"    // Lever indices
+#include "dungeon_clock.h"     // Monotonic time
+#include "dungeon_results.h"   // Columnar log of room outcomes
+#include "dungeon_corpus.h"    // Barrier phrases from a text file
+
+// Cost assumed for one room check until the dispatcher has measured its own.
+#define INITIAL_CHECK_COST_NS (2000LL)
+
+// The two kinds of job a game can be waiting on.
+enum JobKind {
+    JOB_OPEN,   // Open the game's next room
+    JOB_CHECK   // Check the open room for an answer, a pick to judge, or its timeout
+};
+
+// One game: the room it is playing, the answer it expects, and its pending job.
+struct Game {
+    int id;
+    struct DungeonSlot *slot;  // NULL until the game is admitted
+    unsigned int seed;         // Private random state, so games do not share rand()
+    int roomsLeft;             // Rooms to play before the treasure room
+    int round;                 // Rooms opened so far
+    int roomType;              // enum RoomType of the open room
+    int stage;                 // Treasure room: 0 = waiting for levers, 1-4 = revealing, 5 = collecting
+    long long roomDeadline;    // When the open room closes
+    float trapValue;           // Angle the trap is set to
+    char answer[SPELL_BUFFER_SIZE]; // Decoded barrier spell
+    long long phrase;          // Offset of the answer in the spell corpus, -1 if it was generated
+    char treasure[4];          // Treasure of this game
+    long long arrival;         // When the game asked for a slot
+    bool deferred;             // Whether admission had to wait at least once
+    enum JobKind job;          // The pending job
+    long long release;         // Earliest time the job may run
+    long long deadline;        // Time by which the job should have run
+};
+
+// Binary min-heap of games, keyed by job release time or by job deadline.
+struct GameHeap {
+    struct Game **items;
+    int count;
+    bool byDeadline;
+};
+
+// --- Global Variables ---
+struct DungeonSlots *slots = MAP_FAILED;  // The mapped multi-game segment
+size_t slots_size = 0;                    // Size of the mapping
+long long check_cost = INITIAL_CHECK_COST_NS; // Moving average of one room check, in ns
+int admitted_games = 0;                   // Games currently holding a slot
+unsigned long traffic_lines = 0;          // Slot cache lines touched, summed over the rooms played
+unsigned long traffic_rooms = 0;          // Rooms counted in traffic_lines
+struct ResultsWriter results;             // Columnar results log, unused without a results directory
+struct SpellCorpus corpus;                // Spell corpus every game draws its barriers from, if one is set
+
+// Flag to control the dispatcher's exit, set by the SIGINT handler.
+volatile sig_atomic_t exit_flag = 0;
+
+// --- Function Definitions ---
+
+/*
+ * sigint_handler - Handles the SIGINT signal (Ctrl+C) for graceful exit.
+ * @signum: The signal number (SIGINT).
+ */
+void sigint_handler(int signum) {
+    (void)signum;
+    exit_flag = 1;
+}
+
+/*
+ * stat_inc - Increments one of the shared scheduler counters.
+ * @counter: A field of slots->stats.
+ */
+static inline void stat_inc(unsigned long *counter) {
+    __atomic_fetch_add(counter, 1, __ATOMIC_RELAXED);
+}
+
+/*
+ * heap_key - Returns the value a heap is ordered by.
+ */
+static inline long long heap_key(const struct GameHeap *heap, const struct Game *game) {
+    return heap->byDeadline ? game->deadline : game->release;
+}
+
+/*
+ * heap_push - Adds a game to a heap.
+ */
+void heap_push(struct GameHeap *heap, struct Game *game) {
+    int i = heap->count++;
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (heap_key(heap, heap->items[parent]) <= heap_key(heap, game)) {
+            break;
+        }
+        heap->items[i] = heap->items[parent];
+        i = parent;
+    }
+    heap->items[i] = game;
+}
+
+/*
+ * heap_pop - Removes and returns the game with the smallest key.
+ */
+struct Game *heap_pop(struct GameHeap *heap) {
+    struct Game *top = heap->items[0];
+    struct Game *last = heap->items[--heap->count];
+    int i = 0;
+    for (;;) {
+        int child = 2 * i + 1;
+        if (child >= heap->count) {
+            break;
+        }
+        if (child + 1 < heap->count && heap_key(heap, heap->items[child + 1]) < heap_key(heap, heap->items[child])) {
+            child++;
+        }
+        if (heap_key(heap, last) <= heap_key(heap, heap->items[child])) {
+            break;
+        }
+        heap->items[i] = heap->items[child];
+        i = child;
+    }
+    heap->items[i] = last;
+    return top;
+}
+
+/*
+ * schedulable - EDF utilization test for a number of admitted games.
+ * Each game needs one check of cost check_cost per MASTER_POLL_INTERVAL.
+ */
+static bool schedulable(int games) {
+    double utilization = (double)games * check_cost / (MASTER_POLL_INTERVAL * NSEC_PER_USEC);
+    return utilization <= MASTER_MAX_UTILIZATION;
+}
+
+/*
+ * make_spell - Writes a random barrier spell and its decoded answer for a game.
+ * The answer is drawn from the spell corpus if one is open, and made of random words otherwise.
+ * The first character of the spell is the Caesar key, as the wizard expects.
+ * @game: The game; the answer is stored in game->answer.
+ * @encoded: The barrier buffer (SPELL_BUFFER_SIZE + 1 bytes).
+ */
+void make_spell(struct Game *game, char *encoded) {
+    int length = 0;
+    game->phrase = -1;
+    if (corpus.text != NULL) {
+        uint64_t random = (uint64_t)rand_r(&game->seed) << 31;
+        random |= (uint64_t)rand_r(&game->seed);
+        game->phrase = corpus_draw(&corpus, random, game->answer);
+        length = (int)strlen(game->answer);
+    }
+    if (game->phrase < 0) {
+        int words = 2 + rand_r(&game->seed) % 5;
+        for (int w = 0; w < words && length < SPELL_BUFFER_SIZE - 12; w++) {
+            if (w > 0) {
+                game->answer[length++] = ' ';
+            }
+            int letters = 2 + rand_r(&game->seed) % 7;
+            for (int l = 0; l < letters; l++) {
+                char base = (w == 0 && l == 0) ? 'A' : 'a';
+                game->answer[length++] = base + rand_r(&game->seed) % 26;
+            }
+        }
+        game->answer[length++] = '?';
+        game->answer[length] = '\0';
+    }
+
+    char key = 'A' + rand_r(&game->seed) % 58; // Any letter, upper or lower case, and a few symbols
+    encoded[0] = key;
+    for (int i = 0; i <= length; i++) {
+        char c = game->answer[i];
+        if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')) {
+            char base = (c >= 'a') ? 'a' : 'A';
+            c = base + (c - base + key % 26) % 26;
+        }
+        encoded[i + 1] = c;
+    }
+}
+
+/*
+ * next_room_type - Picks the type of a game's next room.
+ * Plays random allowed rooms until roomsLeft runs out, then the treasure room.
+ */
+int next_room_type(struct Game *game) {
+    int allowed[ROLE_COUNT]; // One kind of room per character
+    int count = 0;
+    if (ALLOW_BARBARIAN) allowed[count++] = ROOM_ENEMY;
+    if (ALLOW_WIZARD) allowed[count++] = ROOM_BARRIER;
+    if (ALLOW_ROGUE) allowed[count++] = ROOM_TRAP;
+    if (game->roomsLeft <= 0 || count == 0) {
+        return ROOM_TREASURE;
+    }
+    return allowed[rand_r(&game->seed) % count];
+}
+
+/*
+ * schedule_check - Makes a game's next job a check of its open room.
+ * @game: The game.
+ * @now: Current time.
+ */
+void schedule_check(struct Game *game, long long now) {
+    game->job = JOB_CHECK;
+    game->release = now + MASTER_POLL_INTERVAL * NSEC_PER_USEC;
+    if (game->release > game->roomDeadline) {
+        game->release = game->roomDeadline;
+    }
+    game->deadline = game->roomDeadline;
+    if (game->roomType == ROOM_TRAP) {
+        long long tick = game->release + TIME_BETWEEN_ROGUE_TICKS * NSEC_PER_USEC;
+        if (tick < game->deadline) {
+            game->deadline = tick;
+        }
+    }
+}
+
+/*
+ * open_room - Fills in and announces a game's next room.
+ * @game: The game.
+ * @now: Current time.
+ */
+void open_room(struct Game *game, long long now) {
+    struct DungeonSlot *slot = game->slot;
+    SlotDungeon *dungeon = &slot->dungeon;
+    long long budget = 0;
+
+    game->roomType = next_room_type(game);
+    switch (game->roomType) {
+    case ROOM_ENEMY:
+        dungeon->barbarian.attack = 0;
+        dungeon->enemy.health = 1 + rand_r(&game->seed) % 1000;
+        budget = SECONDS_TO_ATTACK * NSEC_PER_SEC;
+        break;
+    case ROOM_BARRIER:
+        dungeon_slot_wizard(slots, slot)[0] = '\0';
+        __atomic_store_n(&dungeon->spellLength, 0, __ATOMIC_RELAXED);
+        make_spell(game, dungeon_slot_barrier(slots, slot));
+        budget = SECONDS_TO_GUESS_BARRIER * NSEC_PER_SEC;
+        break;
+    case ROOM_TRAP:
+        game->trapValue = rand_r(&game->seed) % MAX_PICK_ANGLE;
+        dungeon->rogue.pick = MAX_PICK_ANGLE / 2.0;
+        dungeon->trap.locked = true;
+        dungeon->trap.direction = 'w';
+        budget = SECONDS_TO_PICK * NSEC_PER_SEC;
+        break;
+    default:
+        game->stage = 0;
+        for (int i = 0; i < 4; i++) {
+            game->treasure[i] = 'a' + rand_r(&game->seed) % 26;
+        }
+        memset(dungeon->treasure, 0, sizeof(dungeon->treasure));
+        memset(dungeon->spoils, 0, sizeof(dungeon->spoils));
+        budget = TIME_TREASURE_AVAILABLE * NSEC_PER_SEC;
+        break;
+    }
+    game->roomDeadline = now + budget;
+    __atomic_store_n(&dungeon->roomDeadline, game->roomDeadline, __ATOMIC_RELAXED);
+    slot->roomType = game->roomType;
+    slot->roomOpened = now;
+    game->round++;
+    __atomic_add_fetch(&slot->roomSeq, 1, __ATOMIC_RELEASE);
+    stat_inc(&slots->stats.roomsOpened);
+    schedule_check(game, now);
+}
+
+/*
+ * check_room - Checks a game's open room once.
+ * Judges a pending trap pick and advances the treasure room as a side effect.
+ * @game: The game.
+ * @now: Current time.
+ * Returns 1 if the room was passed, -1 if it failed, 0 if it is still open.
+ */
+int check_room(struct Game *game, long long now) {
+    struct DungeonSlot *slot = game->slot;
+    SlotDungeon *dungeon = &slot->dungeon;
+
+    switch (game->roomType) {
+    case ROOM_ENEMY:
+        if (__atomic_load_n(&dungeon->barbarian.attack, __ATOMIC_ACQUIRE) == dungeon->enemy.health) {
+            return 1;
+        }
+        break;
+    case ROOM_BARRIER: {
+        int length = __atomic_load_n(&dungeon->spellLength, __ATOMIC_ACQUIRE);
+        if (length > 0) {
+            // The first answer counts; a wrong one fails the room at once.
+            return ((size_t)length == strlen(game->answer) &&
+                    memcmp(dungeon_slot_wizard(slots, slot), game->answer, length) == 0) ? 1 : -1;
+        }
+        break;
+    }
+    case ROOM_TRAP: {
+        char direction = __atomic_load_n(&dungeon->trap.direction, __ATOMIC_ACQUIRE);
+        if (direction == 't' || direction == 'w') {
+            if (now > game->deadline + MASTER_DEADLINE_SLACK * NSEC_PER_USEC) {
+                stat_inc(&slots->stats.missedTrapJudge);
+            }
+            float pick = dungeon->rogue.pick;
+            if (pick >= game->trapValue - LOCK_THRESHOLD && pick <= game->trapValue + LOCK_THRESHOLD) {
+                dungeon->trap.locked = false;
+                __atomic_store_n(&dungeon->trap.direction, '-', __ATOMIC_RELEASE);
+                return 1;
+            }
+            __atomic_store_n(&dungeon->trap.direction, game->trapValue > pick ? 'u' : 'd', __ATOMIC_RELEASE);
+        }
+        break;
+    }
+    default: {
+        int one = 1, two = 1;
+        sem_getvalue(&slot->levers[LEVER_ONE], &one);
+        sem_getvalue(&slot->levers[LEVER_TWO], &two);
+        if (game->stage == 0 && one == 0 && two == 0) {
+            game->stage = 1; // Both levers are held: the door opens.
+        } else if (game->stage >= 1 && game->stage <= 4) {
+            // Reveal one character per check, as the treasure slides out.
+            __atomic_store_n(&dungeon->treasure[game->stage - 1], game->treasure[game->stage - 1], __ATOMIC_RELEASE);
+            game->stage++;
+        } else if (game->stage == 5 && one > 0 && two > 0 &&
+                   memcmp(dungeon->spoils, game->treasure, sizeof(game->treasure)) == 0) {
+            return 1; // Treasure copied and both levers let go.
+        }
+        break;
+    }
+    }
+    return now >= game->roomDeadline ? -1 : 0;
+}
+
+/*
+ * admit_game - Gives a game a free slot and schedules its first room.
+ */
+void admit_game(struct Game *game, struct DungeonSlot *slot, long long now) {
+    game->slot = slot;
+    memset(&slot->dungeon, 0, sizeof(slot->dungeon));
+    slot->dungeon.running = true;
+    slot->dungeon.dungeonPID = getpid();
+    game->job = JOB_OPEN;
+    game->release = now;
+    game->deadline = now + MASTER_DISPATCH_BUDGET * NSEC_PER_USEC;
+    admitted_games++;
+    stat_inc(&slots->stats.gamesAdmitted);
+}
+
+/*
+ * finish_game - Ends a game and frees its slot.
+ * Levers still held (e.g. by a character that missed the door) are reset to free.
+ * @game: The game.
+ * Returns the freed slot.
+ */
+struct DungeonSlot *finish_game(struct Game *game) {
+    struct DungeonSlot *slot = game->slot;
+    slot->dungeon.running = false;
+    for (int lever = 0; lever < 2; lever++) {
+        __atomic_store_n(&slot->dungeon.levers[lever].owner, 0, __ATOMIC_RELEASE);
+        int value = 1;
+        sem_getvalue(&slot->levers[lever], &value);
+        for (; value < 1; value++) {
+            sem_post(&slot->levers[lever]);
+        }
+    }
+    slot->roomType = ROOM_NONE;
+    game->slot = NULL;
+    admitted_games--;
+    stat_inc(&slots->stats.gamesFinished);
+    return slot;
+}
+
+/*
+ * touch_lines - Adds the cache lines holding @size bytes at @at to @lines, unless already there.
+ * Returns the new number of lines.
+ */
+static int touch_lines(uintptr_t *lines, int count, const void *at, size_t size) {
+    uintptr_t first = (uintptr_t)at / DUNGEON_CACHE_LINE;
+    uintptr_t last = ((uintptr_t)at + size - 1) / DUNGEON_CACHE_LINE;
+    for (uintptr_t line = first; line <= last; line++) {
+        bool seen = false;
+        for (int i = 0; i < count && !seen; i++) {
+            seen = (lines[i] == line);
+        }
+        if (!seen) {
+            lines[count++] = line;
+        }
+    }
+    return count;
+}
+
+/*
+ * room_lines - Returns how many cache lines of shared memory a game's room touched: those
+ * holding the fields the master and the host read or write for that kind of room. Each of them
+ * moves between the two processes' cores at least once per room, so this is the room's share
+ * of coherence traffic, which the slot layout decides.
+ * @game: The game, whose room has just closed.
+ */
+static int room_lines(struct Game *game) {
+    struct DungeonSlot *slot = game->slot;
+    SlotDungeon *dungeon = &slot->dungeon;
+    uintptr_t lines[16];
+    int count = 0;
+#define TOUCH(field) (count = touch_lines(lines, count, &(field), sizeof(field)))
+    TOUCH(slot->roomSeq);
+    TOUCH(slot->roomType);
+    TOUCH(slot->roomOpened);
+    TOUCH(dungeon->roomDeadline);
+    switch (game->roomType) {
+    case ROOM_ENEMY:
+        TOUCH(dungeon->enemy.health);
+        TOUCH(dungeon->barbarian.attack);
+        break;
+    case ROOM_BARRIER: {
+        size_t length = strlen(game->answer);
+        TOUCH(dungeon->spellLength);
+        count = touch_lines(lines, count, dungeon_slot_barrier(slots, slot), length + 2); // Key, spell, terminator
+        count = touch_lines(lines, count, dungeon_slot_wizard(slots, slot), length + 1);
+        break;
+    }
+    case ROOM_TRAP:
+        TOUCH(dungeon->rogue.pick);
+        TOUCH(dungeon->trap);
+        break;
+    default:
+        TOUCH(dungeon->running);
+        TOUCH(dungeon->treasure);
+        TOUCH(dungeon->spoils);
+        TOUCH(dungeon->levers);
+        TOUCH(slot->levers);
+        break;
+    }
+#undef TOUCH
+    return count;
+}
+
+/*
+ * record_room - Appends a game's closed room to the results log.
+ * @passed: Whether the room was won.
+ * @now: When it closed.
+ */
+void record_room(struct Game *game, bool passed, long long now) {
+    SlotDungeon *dungeon = &game->slot->dungeon;
+    struct ResultsRow row;
+    memset(&row, 0, sizeof(row));
+    row.game = (long long)getpid() << 32 | game->id;
+    row.round = game->round - 1;
+    row.kind = game->roomType;
+    row.success = passed;
+    row.latency = now - game->slot->roomOpened;
+    if (game->roomType == ROOM_ENEMY) {
+        row.param = dungeon->enemy.health;
+        row.answer = __atomic_load_n(&dungeon->barbarian.attack, __ATOMIC_RELAXED);
+    } else if (game->roomType == ROOM_BARRIER) {
+        row.param = game->phrase < 0 ? -1 : game->phrase | RESULTS_CORPUS_PHRASE;
+        row.key = (unsigned char)dungeon_slot_barrier(slots, game->slot)[0];
+        row.answer = __atomic_load_n(&dungeon->spellLength, __ATOMIC_RELAXED);
+    } else {
+        row.param = (long long)game->trapValue;
+        row.answer = dungeon->rogue.pick;
+    }
+    results_append(&results, &row);
+}
+
+/*
+ * run_job - Runs a game's pending job and schedules the next one.
+ * @game: The game.
+ * @now: Current time.
+ * Returns false once the game is over.
+ */
+bool run_job(struct Game *game, long long now) {
+    if (game->job == JOB_OPEN) {
+        if (now > game->deadline) {
+            stat_inc(&slots->stats.missedDispatch);
+        }
+        open_room(game, now);
+        return true;
+    }
+
+    int result = check_room(game, now);
+    if (result == 0) {
+        schedule_check(game, now);
+        return true;
+    }
+    if (now > game->roomDeadline + MASTER_DEADLINE_SLACK * NSEC_PER_USEC) {
+        stat_inc(&slots->stats.missedVerify);
+    }
+    stat_inc(result > 0 ? &slots->stats.roomsPassed : &slots->stats.roomsFailed);
+    traffic_lines += room_lines(game);
+    traffic_rooms++;
+    if (game->roomType == ROOM_TREASURE) {
+        return false;
+    }
+    record_room(game, result > 0, now);
+    game->roomsLeft--;
+    game->job = JOB_OPEN;
+    game->release = now;
+    game->deadline = now + MASTER_DISPATCH_BUDGET * NSEC_PER_USEC;
+    return true;
+}
+
+/*
+ * main - Creates the slots, plays every game, reports, and cleans up.
+ */
+int main(int argc, char *argv[]) {
+    int slot_count = 16;
+    int game_count = 64;
+    int rounds = NUM_ROUNDS;
+    unsigned int seed = (unsigned int)getpid();
+    int option;
+    while ((option = getopt(argc, argv, "s:g:r:S:")) != -1) {
+        switch (option) {
+        case 's': slot_count = atoi(optarg); break;
+        case 'g': game_count = atoi(optarg); break;
+        case 'r': rounds = atoi(optarg); break;
+        case 'S': seed = (unsigned int)atoi(optarg); break;
+        default:
+            fprintf(stderr, "Usage: %s [-s slots] [-g games] [-r rounds] [-S seed]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (slot_count < 1 || game_count < 1 || rounds < 0) {
+        fprintf(stderr, "MASTER: slots and games must be positive.\n");
+        return EXIT_FAILURE;
+    }
+    printf("[MASTER] Process started. PID: %d\n", getpid());
+
+    // --- 1. Create the Slots ---
+    shm_unlink(DUNGEON_SLOTS_SHM_NAME); // Drop a segment left behind by an earlier run.
+    int fd = shm_open(DUNGEON_SLOTS_SHM_NAME, O_CREAT | O_RDWR, 0666);
+    if (fd == -1) {
+        perror("MASTER: shm_open failed");
+        return EXIT_FAILURE;
+    }
+    slots_size = dungeon_slots_size(slot_count);
+    if (ftruncate(fd, slots_size) == -1) {
+        perror("MASTER: ftruncate failed");
+        close(fd);
+        shm_unlink(DUNGEON_SLOTS_SHM_NAME);
+        return EXIT_FAILURE;
+    }
+    slots = (struct DungeonSlots *)mmap(NULL, slots_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd); // The mapping stays valid after the descriptor is closed.
+    if (slots == MAP_FAILED) {
+        perror("MASTER: mmap failed");
+        shm_unlink(DUNGEON_SLOTS_SHM_NAME);
+        return EXIT_FAILURE;
+    }
+    memset(slots, 0, slots_size);
+    slots->count = slot_count;
+    slots->layout = DUNGEON_SLOTS_LAYOUT;
+    for (int s = 0; s < slot_count; s++) {
+        for (int lever = 0; lever < 2; lever++) {
+            if (sem_init(&slots->slots[s].levers[lever], 1, 1) == -1) {
+                perror("MASTER: sem_init failed");
+                munmap(slots, slots_size);
+                shm_unlink(DUNGEON_SLOTS_SHM_NAME);
+                return EXIT_FAILURE;
+            }
+        }
+    }
+    __atomic_store_n(&slots->running, true, __ATOMIC_RELEASE);
+    printf("[MASTER] Created %d slots for %d games of %d rounds.\n", slot_count, game_count, rounds);
+    const char *results_path = results_dir();
+    if (results_path != NULL) {
+        if (results_open(&results, results_path) == 0) {
+            printf("[MASTER] Writing room results to %s.\n", results_path);
+        } else {
+            fprintf(stderr, "MASTER: playing without a results log.\n");
+        }
+    }
+    const char *corpus_file = corpus_path();
+    if (corpus_file != NULL) {
+        if (corpus_open(&corpus, corpus_file) == 0) {
+            printf("[MASTER] Drawing barrier phrases from %s (%.1f MiB).\n", corpus_file, corpus.size / 1048576.0);
+        } else {
+            fprintf(stderr, "MASTER: using generated barrier phrases.\n");
+        }
+    }
+
+    // --- 2. Set up SIGINT ---
+    struct sigaction sa_sigint;
+    memset(&sa_sigint, 0, sizeof(sa_sigint));
+    sa_sigint.sa_handler = sigint_handler;
+    if (sigaction(SIGINT, &sa_sigint, NULL) == -1) {
+        perror("MASTER: sigaction failed for SIGINT");
+    }
+
+    // --- 3. Prepare the Games ---
+    struct Game *games = calloc(game_count, sizeof(struct Game));
+    struct Game **timer_items = calloc(game_count, sizeof(struct Game *));
+    struct Game **ready_items = calloc(game_count, sizeof(struct Game *));
+    struct DungeonSlot **free_slots = calloc(slot_count, sizeof(struct DungeonSlot *));
+    if (games == NULL || timer_items == NULL || ready_items == NULL || free_slots == NULL) {
+        perror("MASTER: calloc failed");
+        munmap(slots, slots_size);
+        shm_unlink(DUNGEON_SLOTS_SHM_NAME);
+        return EXIT_FAILURE;
+    }
+    struct GameHeap timers = { timer_items, 0, false };
+    struct GameHeap ready = { ready_items, 0, true };
+    int free_count = 0;
+    for (int s = slot_count - 1; s >= 0; s--) {
+        free_slots[free_count++] = &slots->slots[s];
+    }
+
+    printf("[MASTER] Waiting %d s for hosts to attach...\n", MASTER_START_DELAY);
+    clock_sleep(MASTER_START_DELAY * NSEC_PER_SEC);
+
+    long long start = clock_now();
+    for (int g = 0; g < game_count; g++) {
+        games[g].id = g;
+        games[g].seed = seed + (unsigned int)g * 2654435761u;
+        games[g].roomsLeft = rounds;
+        games[g].arrival = start;
+    }
+
+    // --- 4. Dispatch ---
+    int next_pending = 0; // Games are admitted in arrival order.
+    int done = 0;         // Games finished or rejected
+    while (done < game_count && exit_flag == 0) {
+        long long now = clock_now();
+
+        // Admit waiting games while a slot is free and the schedule stays feasible.
+        while (next_pending < game_count) {
+            struct Game *game = &games[next_pending];
+            if (now - game->arrival > MASTER_ADMISSION_TIMEOUT * NSEC_PER_SEC) {
+                stat_inc(&slots->stats.gamesRejected);
+                next_pending++;
+                done++;
+                continue;
+            }
+            if (free_count == 0 || !schedulable(admitted_games + 1)) {
+                if (!game->deferred) {
+                    game->deferred = true;
+                    stat_inc(&slots->stats.gamesDeferred);
+                }
+                break;
+            }
+            admit_game(game, free_slots[--free_count], now);
+            heap_push(&timers, game);
+            next_pending++;
+        }
+
+        // Release every job whose time has come, then run the one with the earliest deadline.
+        while (timers.count > 0 && timers.items[0]->release <= now) {
+            heap_push(&ready, heap_pop(&timers));
+        }
+        if (ready.count == 0) {
+            long long wait = MASTER_POLL_INTERVAL * NSEC_PER_USEC;
+            if (timers.count > 0 && timers.items[0]->release - now < wait) {
+                wait = timers.items[0]->release - now;
+            }
+            clock_sleep(wait);
+            continue;
+        }
+        struct Game *game = heap_pop(&ready);
+        bool checking = (game->job == JOB_CHECK);
+        if (run_job(game, now)) {
+            heap_push(&timers, game);
+        } else {
+            free_slots[free_count++] = finish_game(game);
+            done++;
+        }
+        if (checking) {
+            // Moving average over the last ~16 checks, used by the admission test.
+            check_cost += (clock_now() - now - check_cost) / 16;
+        }
+    }
+    double elapsed = (double)(clock_now() - start) / NSEC_PER_SEC;
+
+    // --- 5. Report and Clean Up ---
+    __atomic_store_n(&slots->running, false, __ATOMIC_RELEASE);
+    struct SchedulerStats *stats = &slots->stats;
+    printf("[MASTER] Games in %.2f s: admitted %lu, deferred %lu, rejected %lu, finished %lu.\n",
+           elapsed, stats->gamesAdmitted, stats->gamesDeferred, stats->gamesRejected, stats->gamesFinished);
+    printf("[MASTER] Rooms: opened %lu, passed %lu, failed %lu (%.1f rooms/s).\n",
+           stats->roomsOpened, stats->roomsPassed, stats->roomsFailed,
+           elapsed > 0 ? stats->roomsOpened / elapsed : 0.0);
+    printf("[MASTER] Missed deadlines: dispatch %lu, verify %lu, trap judge %lu.\n",
+           stats->missedDispatch, stats->missedVerify, stats->missedTrapJudge);
+    size_t game_bytes = sizeof(struct DungeonSlot);
+#if COMPACT_SLOTS
+    game_bytes += sizeof(struct SlotSpells);
+#endif
+    printf("[MASTER] Slot layout: %s, %zu bytes per game; a room touched %.2f cache lines (%.0f bytes) on average.\n",
+           COMPACT_SLOTS ? "compact" : "full", game_bytes,
+           traffic_rooms > 0 ? (double)traffic_lines / traffic_rooms : 0.0,
+           traffic_rooms > 0 ? (double)traffic_lines * DUNGEON_CACHE_LINE / traffic_rooms : 0.0);
+    printf("[MASTER] Room check cost: %lld ns, so at most %d games can be admitted at once.\n",
+           check_cost, (int)(MASTER_MAX_UTILIZATION * MASTER_POLL_INTERVAL * NSEC_PER_USEC / (check_cost > 0 ? check_cost : 1)));
+
+    if (results_close(&results) == -1) {
+        fprintf(stderr, "MASTER: the last rooms could not be written to the results log.\n");
+    }
+    corpus_close(&corpus);
+
+    clock_sleep(NSEC_PER_SEC / 10); // Give hosts a moment to notice that the games are over.
+    for (int s = 0; s < slot_count; s++) {
+        sem_destroy(&slots->slots[s].levers[0]);
+        sem_destroy(&slots->slots[s].levers[1]);
+    }
+    free(games);
+    free(timer_items);
+    free(ready_items);
+    free(free_slots);
+    if (munmap(slots, slots_size) == -1) {
+        perror("MASTER: munmap failed");
+    }
+    if (shm_unlink(DUNGEON_SLOTS_SHM_NAME) == -1) {
+        perror("MASTER: shm_unlink failed");
+    }
+    printf("[MASTER] Cleanup complete. Exiting.\n");
+    return EXIT_SUCCESS;
+}
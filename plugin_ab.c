@@ -0,0 +1,235 @@
+/*
+ * plugin_ab.c - Plays two character plugins (see character_plugin.h) against the same
+ * seeded scenario and compares them.
+ * The traps and barriers are drawn with engine.c's own generator (engine_draw_trap,
+ * engine_draw_barrier), so a seed gives the rooms a real game with that seed would deal.
+ * Each plugin then plays the same rooms in this process, without a dungeon or signals:
+ *
+ *   Traps    - every pick is judged at once, the way engine.c judges with LOCK_THRESHOLD.
+ *              A trap counts as failed after as many judgements as dungeon.o would make in
+ *              SECONDS_TO_PICK. Reported as judgements ("ticks") per unlocked trap.
+ *   Barriers - every spell is checked against its answer once, then decoded repeatedly for
+ *              AB_DECODE_TIME to measure decode throughput.
+ *
+ * Usage: ./plugin_ab [-S seed] [-r rooms] ./plugin_a.so ./plugin_b.so
+ */
+
+// Include necessary headers for system calls and standard libraries.
+#define _XOPEN_SOURCE 700       // Ensure POSIX features are available
+#define _POSIX_C_SOURCE 200809L // Ensure POSIX.1-2008 compliance
+
+#include <stdio.h>      // For printf, fprintf
+#include <stdlib.h>     // For malloc, free, atoi
+#include <string.h>     // For strcmp, strcpy
+#include <unistd.h>     // For getopt, getpid
+
+#include "dungeon_info.h"       // Defines the resource names engine.o expects
+#include "dungeon_settings.h"
+#include "dungeon_clock.h"
+#include "dungeon_slots.h"      // For enum RoomType
+#include "character_plugin.h"
+#include "engine.h"
+
+// Most judgements a trap gets before it counts as failed: one per dungeon.o tick.
+#define AB_TRAP_TICKS (SECONDS_TO_PICK * 1000000LL / TIME_BETWEEN_ROGUE_TICKS)
+
+// How long each plugin decodes barriers for the throughput figure.
+#define AB_DECODE_TIME (NSEC_PER_SEC / 2)
+
+// The rooms both plugins play.
+struct Scenario {
+    int rooms;
+    float *traps;                              // Trap angles
+    char (*spells)[SPELL_BUFFER_SIZE + 1];     // Encoded barriers, key first, as Barrier.spell
+    char (*answers)[SPELL_BUFFER_SIZE];        // What each barrier decodes to
+};
+
+// How one plugin did.
+struct Result {
+    char name[32];             // Copied, since the plugin is unloaded before the report
+    int unlocked;              // Traps unlocked within AB_TRAP_TICKS
+    long long ticks;           // Judgements over the unlocked traps
+    long long mostTicks;       // Most judgements any unlocked trap needed
+    int decoded;               // Barriers decoded correctly
+    bool decodes;              // Whether the plugin decodes barriers at all
+    double spellsPerSecond;    // Decode throughput
+};
+
+/*
+ * scenario_draw - Draws @rooms traps and barriers from an engine seeded with @seed.
+ */
+static int scenario_draw(struct Scenario *scenario, int rooms, uint64_t seed) {
+    scenario->rooms = rooms;
+    scenario->traps = malloc(sizeof(float) * rooms);
+    scenario->spells = malloc(sizeof(*scenario->spells) * rooms);
+    scenario->answers = malloc(sizeof(*scenario->answers) * rooms);
+    if (scenario->traps == NULL || scenario->spells == NULL || scenario->answers == NULL) {
+        return -1;
+    }
+    struct DungeonEngine engine;
+    engine_init(&engine, 0, 0, 0, seed);
+    for (int i = 0; i < rooms; i++) {
+        scenario->traps[i] = engine_draw_trap(&engine);
+        engine_draw_barrier(&engine, scenario->spells[i]);
+        strcpy(scenario->answers[i], engine.barrierAnswer);
+    }
+    return 0;
+}
+
+/*
+ * play_traps - Runs the plugin's search over every trap, following the trap protocol.
+ */
+static void play_traps(const struct Scenario *scenario, struct PluginHandle *handle, struct Result *result) {
+    const struct CharacterPlugin *plugin = handle->plugin;
+    if (plugin->on_trap_feedback == NULL) {
+        return;
+    }
+    float pick = plugin->on_trap_feedback(handle->state, 0.0, 'w');
+    for (int i = 0; i < scenario->rooms; i++) {
+        float trap = scenario->traps[i];
+        if (plugin->on_room != NULL) {
+            plugin->on_room(handle->state, ROOM_TRAP, NULL, NULL, 0);
+        }
+        for (long long tick = 1; tick <= AB_TRAP_TICKS && pick >= 0.0; tick++) {
+            char direction = '-';
+            if (pick < trap - LOCK_THRESHOLD) {
+                direction = 'u';
+            } else if (pick > trap + LOCK_THRESHOLD) {
+                direction = 'd';
+            }
+            pick = plugin->on_trap_feedback(handle->state, pick, direction);
+            if (direction == '-') {
+                result->unlocked++;
+                result->ticks += tick;
+                if (tick > result->mostTicks) {
+                    result->mostTicks = tick;
+                }
+                break;
+            }
+        }
+        if (pick < 0.0) {
+            pick = MAX_PICK_ANGLE / 2.0; // Gave up: the next trap starts from the middle.
+        }
+    }
+}
+
+/*
+ * play_barriers - Checks the plugin's decoder on every barrier, then times it.
+ */
+static void play_barriers(const struct Scenario *scenario, struct PluginHandle *handle, struct Result *result) {
+    const struct CharacterPlugin *plugin = handle->plugin;
+    char output[SPELL_BUFFER_SIZE];
+    if (plugin->on_room == NULL ||
+        plugin->on_room(handle->state, ROOM_BARRIER, scenario->spells[0], output, SPELL_BUFFER_SIZE) < 0) {
+        return;
+    }
+    result->decodes = true;
+    for (int i = 0; i < scenario->rooms; i++) {
+        plugin->on_room(handle->state, ROOM_BARRIER, scenario->spells[i], output, SPELL_BUFFER_SIZE);
+        if (strcmp(output, scenario->answers[i]) == 0) {
+            result->decoded++;
+        }
+    }
+
+    long long spells = 0;
+    long long start = clock_now();
+    long long spent = 0;
+    while (spent < AB_DECODE_TIME) {
+        for (int i = 0; i < scenario->rooms; i++) {
+            plugin->on_room(handle->state, ROOM_BARRIER, scenario->spells[i], output, SPELL_BUFFER_SIZE);
+        }
+        spells += scenario->rooms;
+        spent = clock_now() - start;
+    }
+    result->spellsPerSecond = (double)spells * NSEC_PER_SEC / spent;
+}
+
+/*
+ * play - Loads the plugin at @path, plays the scenario with it and unloads it.
+ * Returns 0 on success, -1 if the plugin could not be loaded.
+ */
+static int play(const struct Scenario *scenario, const char *path, struct Result *result) {
+    struct PluginHandle handle;
+    memset(&handle, 0, sizeof(handle));
+    memset(result, 0, sizeof(*result));
+    if (plugin_load(&handle, path) == -1) {
+        return -1;
+    }
+    snprintf(result->name, sizeof(result->name), "%s", handle.plugin->name);
+    play_traps(scenario, &handle, result);
+    play_barriers(scenario, &handle, result);
+    plugin_unload(&handle);
+    return 0;
+}
+
+/*
+ * print_ticks - Prints a plugin's mean judgements per unlocked trap, or "-" if none unlocked.
+ */
+static void print_ticks(const struct Result *result) {
+    if (result->unlocked > 0) {
+        printf(" %14.2f", (double)result->ticks / result->unlocked);
+    } else {
+        printf(" %14s", "-");
+    }
+}
+
+/*
+ * main - Draws the scenario, plays both plugins and prints the comparison.
+ */
+int main(int argc, char *argv[]) {
+    uint64_t seed = (uint64_t)getpid();
+    int rooms = 1000;
+    int option;
+    while ((option = getopt(argc, argv, "S:r:")) != -1) {
+        switch (option) {
+        case 'S': seed = (uint64_t)strtoull(optarg, NULL, 10); break;
+        case 'r': rooms = atoi(optarg); break;
+        default:
+            fprintf(stderr, "Usage: %s [-S seed] [-r rooms] ./plugin_a.so ./plugin_b.so\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (argc - optind != 2 || rooms < 1) {
+        fprintf(stderr, "Usage: %s [-S seed] [-r rooms] ./plugin_a.so ./plugin_b.so\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    struct Scenario scenario;
+    if (scenario_draw(&scenario, rooms, seed) == -1) {
+        perror("PLUGIN_AB: malloc failed");
+        return EXIT_FAILURE;
+    }
+    struct Result results[2];
+    for (int i = 0; i < 2; i++) {
+        if (play(&scenario, argv[optind + i], &results[i]) == -1) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    printf("Scenario: seed %llu, %d traps and %d barriers.\n", (unsigned long long)seed, rooms, rooms);
+    printf("%-28s %14s %14s\n", "", results[0].name, results[1].name);
+    printf("%-28s %14d %14d\n", "Traps unlocked", results[0].unlocked, results[1].unlocked);
+    printf("%-28s", "Mean ticks to unlock");
+    print_ticks(&results[0]);
+    print_ticks(&results[1]);
+    printf("\n%-28s %14lld %14lld\n", "Most ticks to unlock", results[0].mostTicks, results[1].mostTicks);
+    printf("%-28s %14d %14d\n", "Barriers decoded correctly", results[0].decoded, results[1].decoded);
+    printf("%-28s %14.0f %14.0f\n", "Decode throughput (spells/s)", results[0].spellsPerSecond,
+           results[1].spellsPerSecond);
+
+    if (results[0].unlocked > 0 && results[1].unlocked > 0) {
+        double a = (double)results[0].ticks / results[0].unlocked;
+        double b = (double)results[1].ticks / results[1].unlocked;
+        printf("%s needs %.1f%% %s ticks per trap than %s.\n", results[1].name, 100.0 * (b > a ? b - a : a - b) / a,
+               b > a ? "more" : "fewer", results[0].name);
+    }
+    if (results[0].decodes && results[1].decodes && results[0].spellsPerSecond > 0) {
+        printf("%s decodes %.2fx as fast as %s.\n", results[1].name,
+               results[1].spellsPerSecond / results[0].spellsPerSecond, results[0].name);
+    }
+
+    free(scenario.traps);
+    free(scenario.spells);
+    free(scenario.answers);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,81 @@
+/*
+ * plugin_bisect.c - Reference character plugin (see character_plugin.h).
+ * Plain bisection for traps, starting from the middle every time, and the wizard's one-pass
+ * Caesar decoder for barriers. It is the baseline other plugins are compared against in
+ * plugin_ab. Build with `make plugins`; load with DUNGEON_PLUGIN=./plugin_bisect.so.
+ */
+#define _XOPEN_SOURCE 700       // Ensure POSIX features are available
+#define _POSIX_C_SOURCE 200809L // Ensure POSIX.1-2008 compliance
+#define DUNGEON_LIBRARY         // The host program defines the resource names
+
+#include <stdlib.h>     // For malloc, free
+
+#include "character_plugin.h"
+#include "dungeon_settings.h"
+#include "dungeon_slots.h"
+#include "dungeon_spell.h"
+
+// Bounds of the current search.
+struct BisectState {
+    float low;
+    float high;
+};
+
+static int bisect_init(void **state) {
+    struct BisectState *search = malloc(sizeof(struct BisectState));
+    if (search == NULL) {
+        return -1;
+    }
+    search->low = 0.0;
+    search->high = MAX_PICK_ANGLE;
+    *state = search;
+    return 0;
+}
+
+static int bisect_on_room(void *state, int type, const char *input, char *output, int size) {
+    struct BisectState *search = state;
+    if (type == ROOM_BARRIER) {
+        return decode_caesar_cipher(input, output, size);
+    }
+    if (type == ROOM_TRAP) {
+        search->low = 0.0;
+        search->high = MAX_PICK_ANGLE;
+        return 0;
+    }
+    return -1;
+}
+
+/*
+ * bisect_on_trap_feedback - Narrows the bounds to the side the trap is on and probes the middle.
+ */
+static float bisect_on_trap_feedback(void *state, float pick, char direction) {
+    struct BisectState *search = state;
+    if (direction == 'u' && pick > search->low) {
+        search->low = pick;
+    } else if (direction == 'd' && pick < search->high) {
+        search->high = pick;
+    } else if (direction == '-' || direction == 'w') {
+        return MAX_PICK_ANGLE / 2.0; // Park in the middle for the next trap.
+    }
+    if (search->high - search->low <= 0.000001) {
+        // Nothing left between the bounds: the answers contradict each other, so start over
+        // on the side this answer points to.
+        search->low = (direction == 'u') ? pick : 0.0;
+        search->high = (direction == 'd') ? pick : MAX_PICK_ANGLE;
+    }
+    return search->low + (search->high - search->low) / 2.0;
+}
+
+static void bisect_fini(void *state) {
+    free(state);
+}
+
+const struct CharacterPlugin character_plugin = {
+    .abi = CHARACTER_PLUGIN_ABI,
+    .name = "bisect",
+    .init = bisect_init,
+    .on_room = bisect_on_room,
+    .on_trap_feedback = bisect_on_trap_feedback,
+    .on_treasure = NULL,
+    .fini = bisect_fini,
+};
@@ -3,109 +3,209 @@
  * It connects to shared memory and semaphores to interact with the Dungeon Master.
  * The Rogue attempts to disarm traps using a binary search approach and collects
  * treasure from the treasure room after the Barbarian and Wizard hold the levers.
+ * Each probe is placed at the weighted median of a histogram of previously unlocked
+ * trap angles, which is kept in ROGUE_HISTORY_FILE across rounds and games.
+ * A plugin (character_plugin.h) can take over the search in place of the histogram.
+ * Attaching, waiting for rooms and cleaning up are done by the character runtime (character.h).
  */
 
 // Include necessary headers for system calls and standard libraries.
 #define _XOPEN_SOURCE 700       // Ensure POSIX features are available
 #define _POSIX_C_SOURCE 200809L // Ensure POSIX.1-2008 compliance
+#define _DEFAULT_SOURCE         // For syscall (futex, see dungeon_futex.h)
 
 #include <stdio.h>      // For printf, perror
 #include <stdlib.h>     // For exit
-#include <unistd.h>     // For fork, usleep, sleep, getpid, pause
-#include <sys/mman.h>   // For shared memory functions (shm_open, mmap, munmap)
-#include <sys/stat.h>   // For mode constants
+#include <unistd.h>     // For getpid, ftruncate, close
+#include <sys/mman.h>   // For mapping the trap history (mmap, munmap)
 #include <fcntl.h>      // For file control options
-#include <signal.h>     // For signal handling (sigaction, sigsuspend)
-#include <semaphore.h>  // For semaphore functions (sem_open, sem_close, sem_wait, sem_post)
 #include <stdbool.h>    // For bool type
 #include <string.h>     // For memset
 #include <math.h>       // For binary search calculations (midpoint, fabs)
-#include <time.h>       // For time(), difftime()
 
 
 
 // Include custom header files for shared resources and settings.
 #include "dungeon_info.h"   // Defines shared memory/semaphore names and struct layout
 #include "dungeon_settings.h" // Defines signals, MAX_PICK_ANGLE, and other game parameters
+#include "dungeon_clock.h"    // Monotonic deadlines for the search and treasure loops
+#include "dungeon_futex.h"    // Wakes the dungeon as soon as a new pick is published
+#include "dungeon_slots.h"    // For enum RoomType
+#include "character.h"        // Shared attach path, wait strategies, plugins and main loop
 
 // --- Global Variables ---
-// Pointers to shared resources accessed by the main loop and signal handlers.
-struct Dungeon *dungeon_ptr = NULL; // Pointer to the shared Dungeon struct
-sem_t *lever1_sem = SEM_FAILED;     // Pointer to the Lever One semaphore
-sem_t *lever2_sem = SEM_FAILED;     // Pointer to the Lever Two semaphore
-int shm_fd = -1;                    // File descriptor for shared memory (used only during setup)
-
-// Flag to control the main loop's exit, set by the SIGINT handler.
-volatile sig_atomic_t exit_flag = 0;
+void rogue_serve(int signum, unsigned int room);
+
+// The Rogue answers trap rooms.
+struct Character rogue = {
+    .name = "ROGUE",
+    .role = ROLE_ROGUE,
+    .roomType = ROOM_TRAP,
+    .serve = rogue_serve,
+};
+struct Dungeon *dungeon_ptr = NULL; // Shorthand for rogue.dungeon once attached
+
+// --- Trap History ---
+// Identifies a history file written with this layout ("RGH1").
+#define HISTORY_MAGIC (0x52474831u)
+// Once this many unlocks are recorded, all counts are halved so recent games weigh more.
+#define HISTORY_DECAY_TOTAL (1u << 16)
+
+// Histogram of unlocked trap angles, one bin per whole degree from 0 to MAX_PICK_ANGLE.
+struct PickHistory {
+    unsigned int magic;
+    unsigned int total;
+    unsigned int counts[MAX_PICK_ANGLE + 1];
+};
+struct PickHistory *history = NULL; // Mapped from ROGUE_HISTORY_FILE, NULL if unavailable
 
 // --- Function Definitions ---
 
 /*
- * error_exit - Prints an error message and attempts to clean up resources before exiting.
- * @msg: The error message to display.
+ * history_open - Maps the trap history file, creating or resetting it if needed.
+ * The rogue still works without a history (it falls back to plain bisection),
+ * so failures are reported but not fatal.
  */
-void error_exit(const char *msg) {
-    perror(msg); // Print the system error message.
-    // Attempt to unmap shared memory if it was mapped.
-    if (dungeon_ptr != MAP_FAILED && dungeon_ptr != NULL) {
-        munmap(dungeon_ptr, sizeof(struct Dungeon));
-        dungeon_ptr = NULL;
+void history_open(void) {
+    int fd = open(ROGUE_HISTORY_FILE, O_RDWR | O_CREAT, 0644);
+    if (fd == -1) {
+        perror("ROGUE: open history file failed");
+        return;
     }
-    // Close the shared memory file descriptor if it was opened (unlikely at error stage).
-    if (shm_fd != -1) {
-         close(shm_fd);
-         shm_fd = -1;
+    if (ftruncate(fd, sizeof(struct PickHistory)) == -1) {
+        perror("ROGUE: ftruncate history file failed");
+        close(fd);
+        return;
     }
-    // Close semaphore descriptors if they were opened.
-    if (lever1_sem != SEM_FAILED) {
-        sem_close(lever1_sem);
-        lever1_sem = SEM_FAILED;
+    void *map = mmap(NULL, sizeof(struct PickHistory), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd); // The mapping stays valid after the descriptor is closed.
+    if (map == MAP_FAILED) {
+        perror("ROGUE: mmap history file failed");
+        return;
     }
-     if (lever2_sem != SEM_FAILED) {
-        sem_close(lever2_sem);
-        lever2_sem = SEM_FAILED;
+    history = (struct PickHistory *)map;
+
+    // A new file, or one written with a different layout, starts from an empty histogram.
+    if (history->magic != HISTORY_MAGIC) {
+        memset(history, 0, sizeof(struct PickHistory));
+        history->magic = HISTORY_MAGIC;
     }
-    exit(EXIT_FAILURE); // Exit with a failure status.
 }
 
 /*
- * sigint_handler - Handles the SIGINT signal (Ctrl+C) for graceful exit.
- * Sets the global exit_flag to terminate the main loop.
- * NOTE: The main signal handler now also catches SIGINT.
- * @signum: The signal number (SIGINT).
+ * history_probe - Chooses the next pick strictly inside (low, high).
+ * Returns the weighted median of the whole angles in range, where each angle weighs
+ * its recorded count plus one. With no history this is the midpoint, as in plain bisection.
+ * @low: Current lower bound of the search.
+ * @high: Current upper bound of the search.
  */
-void sigint_handler(int signum) {
-    // Setting the flag is the primary action.
-    // The main handler can also check signum == SIGINT.
-    exit_flag = 1;
+float history_probe(float low, float high) {
+    float midpoint = low + (high - low) / 2.0;
+    if (history == NULL || history->total == 0) {
+        return midpoint;
+    }
+
+    // Only angles strictly between the bounds can move the search forward.
+    int first = (low < 0.0) ? 0 : (int)low + 1;
+    int last = (high > MAX_PICK_ANGLE) ? MAX_PICK_ANGLE : (int)high;
+    if ((float)last >= high) last--;
+    if (first > last) {
+        return midpoint;
+    }
+
+    unsigned long mass = 0;
+    for (int angle = first; angle <= last; angle++) {
+        mass += history->counts[angle] + 1;
+    }
+    unsigned long running = 0;
+    for (int angle = first; angle <= last; angle++) {
+        running += history->counts[angle] + 1;
+        if (2 * running >= mass) {
+            return (float)angle;
+        }
+    }
+    return midpoint;
 }
 
 /*
- * rogue_signal_handler - Handles signals from the Dungeon Master (DUNGEON_SIGNAL,
- * SEMAPHORE_SIGNAL) and SIGINT.
+ * history_record - Records a successful unlock in the trap history.
+ * The trap is somewhere within LOCK_THRESHOLD of the winning pick and inside the
+ * search bounds, so every whole angle in that window gets one count. A pick that is not a
+ * finite angle (the segment is shared, so it can hold anything) is not recorded.
+ * @pick: The pick the dungeon accepted.
+ * @low: Lower bound of the search when the trap unlocked.
+ * @high: Upper bound of the search when the trap unlocked.
+ */
+void history_record(float pick, float low, float high) {
+    if (history == NULL || !isfinite(pick)) {
+        return;
+    }
+    float from = pick - LOCK_THRESHOLD;
+    float to = pick + LOCK_THRESHOLD;
+    if (from < low) from = low;
+    if (to > high) to = high;
+    if (from > to || from > MAX_PICK_ANGLE || to < 0.0) {
+        return;
+    }
+
+    int first = (from <= 0.0) ? 0 : (int)from;
+    if ((float)first < from) first++;
+    int last = (to >= MAX_PICK_ANGLE) ? MAX_PICK_ANGLE : (int)to;
+    if (first > last) {
+        return;
+    }
+
+    // Halve everything once the history is large, so it keeps adapting and never overflows.
+    if (history->total >= HISTORY_DECAY_TOTAL) {
+        for (int angle = 0; angle <= MAX_PICK_ANGLE; angle++) {
+            history->counts[angle] /= 2;
+        }
+        history->total /= 2;
+    }
+    for (int angle = first; angle <= last; angle++) {
+        history->counts[angle]++;
+    }
+    history->total++;
+}
+
+/*
+ * publish_pick - Writes a new pick and tells the dungeon it is ready.
+ * Sets the direction to 't', stamps pickTime, then bumps pickSeq and wakes a dungeon waiting
+ * on it, so an event-driven dungeon (engine.c) judges the pick right away instead of on its
+ * next tick, and a ticking one can size its tick from how fast we answer.
+ * @pick: The new pick angle.
+ */
+void publish_pick(float pick) {
+    dungeon_ptr->rogue.pick = pick;
+    dungeon_ptr->trap.direction = 't';
+    __atomic_store_n(&dungeon_ptr->pickTime, clock_now(), __ATOMIC_RELAXED);
+    __atomic_add_fetch(&dungeon_ptr->pickSeq, 1, __ATOMIC_RELEASE);
+    futex_wake(&dungeon_ptr->pickSeq);
+}
+
+/*
+ * rogue_serve - Serves a room the Dungeon Master announced (DUNGEON_SIGNAL, SEMAPHORE_SIGNAL).
  * For traps (DUNGEON_SIGNAL), it now enters an internal loop to complete the search.
- * @signum: The signal number received.
+ * @signum: DUNGEON_SIGNAL or SEMAPHORE_SIGNAL.
+ * @room: Sequence number of the room being served.
  */
-void rogue_signal_handler(int signum) {
+void rogue_serve(int signum, unsigned int room) {
     // --- Static variables to maintain binary search state across signals ---
     // These persist between calls to the handler for DIFFERENT traps.
     static float current_low = 0.0;
     static float current_high = MAX_PICK_ANGLE;
-    
+    static unsigned int trap_room = 0; // Room of the trap the bounds belong to
+    static bool plugin_search = false; // The plugin is searching this trap instead of the histogram
 
-    if (signum == SIGINT) {
-       exit_flag = 1;
-       return; // Just set flag and return
-    }
-
-    if (exit_flag) return; // Check flag again after potential SIGINT
-    if (dungeon_ptr == NULL || dungeon_ptr == MAP_FAILED || !dungeon_ptr->running) return;
+    if (exit_flag || !dungeon_ptr->running) return;
 
 
     if (signum == DUNGEON_SIGNAL) {
 
         // Check trap state *once* when signal arrives
         if (dungeon_ptr->trap.locked) {
+            const struct CharacterPlugin *plugin = character_strategy(&rogue);
+            void *state = rogue.strategy.state;
 
             // --- Reset bounds logic (Attempt 3 approach) ---
             // Reset bounds only if the trap state indicates a new search is needed.
@@ -115,22 +215,36 @@ void rogue_signal_handler(int signum) {
             float initial_pick = dungeon_ptr->rogue.pick; // Read initial pick too
 
             // Reset if direction implies start ('w', 't', '\0') OR if pick is the initial 50.0?
-            // Let's reset if direction is NOT 'u', 'd', or '-'
-            if (initial_direction != 'u' && initial_direction != 'd' && initial_direction != '-') {
+            // Let's reset if direction is NOT 'u', 'd', or '-', or if this is a different trap
+            // room than the bounds were for (the dungeon may already have answered its first pick).
+            if ((initial_direction != 'u' && initial_direction != 'd' && initial_direction != '-') || room != trap_room) {
+                 trap_room = room;
 
                  current_low = 0.0;
                  current_high = MAX_PICK_ANGLE;
-                 
+
+                 // Hand the trap to the plugin if it has a search and accepts the room.
+                 plugin_search = plugin != NULL && plugin->on_trap_feedback != NULL &&
+                                 (plugin->on_room == NULL || plugin->on_room(state, ROOM_TRAP, NULL, NULL, 0) >= 0);
+            }
+            if (plugin == NULL) {
+                 plugin_search = false; // A failed reload left only the built-in search.
             }
+            float park_pick = -1.0;    // Where the plugin wants the pick for the next trap
             // --- End Reset Bounds Logic ---
 
 
             // --- Internal loop to perform binary search ---
-            time_t loop_start_time = time(NULL);
-            while (dungeon_ptr->trap.locked && dungeon_ptr->running && exit_flag == 0) {
+            // Stop half a second before the dungeon gives up, unless it published the exact close time.
+            struct Deadline pick_deadline;
+            deadline_for_room(&pick_deadline, dungeon_ptr, SECONDS_TO_PICK * NSEC_PER_SEC - NSEC_PER_SEC / 2);
+            // engine.c numbers its rooms: once a newer one opens, this trap is over even if the next
+            // one is already locked.
+            while (dungeon_ptr->trap.locked && dungeon_ptr->running && exit_flag == 0 &&
+                   (room == 0 || __atomic_load_n(&dungeon_ptr->roomSeq, __ATOMIC_ACQUIRE) == room)) {
 
                 // Check for timeout
-                if (difftime(time(NULL), loop_start_time) > (SECONDS_TO_PICK - 0.5)) {
+                if (deadline_passed(&pick_deadline)) {
 
                      break; // Exit internal loop
                 }
@@ -142,9 +256,25 @@ void rogue_signal_handler(int signum) {
 
                 if (current_direction == '-') {
 
+                     // The pick was accepted: remember where this trap was.
+                     if (plugin_search) {
+                         park_pick = plugin->on_trap_feedback(state, current_pick, current_direction);
+                     } else {
+                         history_record(current_pick, current_low, current_high);
+                     }
                      // Bounds will be reset below, outside the loop, if trap becomes unlocked
                      break; // Exit internal loop
                 } else if (current_direction == 'u' || current_direction == 'd') {
+                     // --- Let the plugin choose; if it gives up, the built-in search takes over ---
+                     if (plugin_search) {
+                         float next_pick = plugin->on_trap_feedback(state, current_pick, current_direction);
+                         if (next_pick >= 0.0) {
+                             publish_pick(next_pick);
+                             continue;
+                         }
+                         plugin_search = false;
+                     }
+
                      // --- Valid feedback, update bounds ---
                      // Use the 'current_pick' read *in this loop iteration* which
                      // represents the pick the dungeon gave feedback on.
@@ -158,11 +288,10 @@ void rogue_signal_handler(int signum) {
 
                      // --- Calculate and write next pick if bounds valid ---
                     if (current_high > current_low && (current_high - current_low) > 0.000001) {
-                        float next_pick = current_low + (current_high - current_low) / 2.0;
+                        float next_pick = history_probe(current_low, current_high);
 
                         // --- Write to Shared Memory ---
-                        dungeon_ptr->rogue.pick = next_pick;
-                        dungeon_ptr->trap.direction = 't'; // Signal guess made
+                        publish_pick(next_pick); // Signal guess made
                         
                     } else {
 
@@ -176,6 +305,21 @@ void rogue_signal_handler(int signum) {
 
                 current_low = 0.0; // Reset state for the *next* trap
                 current_high = MAX_PICK_ANGLE;
+                // Park the pick where the next trap is most likely to be; the dungeon
+                // evaluates whatever pick is in place when the next trap starts. engine.c
+                // numbers its rooms and has already recorded the winning pick, so the pick is
+                // parked at once, and bumping pickSeq tells it the next room can open. dungeon.o
+                // does not (room is 0): wait a couple of ticks there so it reports the winning
+                // pick first. Either way, leave the pick alone if the next room has already opened
+                // (under dungeon.o, a trap that locked again also counts).
+                if (room == 0) {
+                    clock_sleep(2 * TIME_BETWEEN_ROGUE_TICKS * NSEC_PER_USEC);
+                }
+                if (__atomic_load_n(&dungeon_ptr->roomSeq, __ATOMIC_ACQUIRE) == room && !dungeon_ptr->trap.locked) {
+                    dungeon_ptr->rogue.pick = park_pick >= 0.0 ? park_pick : history_probe(current_low, current_high);
+                    __atomic_add_fetch(&dungeon_ptr->pickSeq, 1, __ATOMIC_RELEASE);
+                    futex_wake(&dungeon_ptr->pickSeq);
+                }
             } 
             
         } else { // Trap not locked when signal arrived
@@ -197,11 +341,12 @@ void rogue_signal_handler(int signum) {
         memset(dungeon_ptr->spoils, '\0', sizeof(dungeon_ptr->spoils)); // Ensure null termination
 
         // Loop while dungeon running, haven't exited, and haven't collected all 4 chars
-        time_t treasure_start_time = time(NULL); // Timeout for treasure
+        struct Deadline treasure_deadline; // Timeout for treasure
+        deadline_for_room(&treasure_deadline, dungeon_ptr, TIME_TREASURE_AVAILABLE * NSEC_PER_SEC);
         while (dungeon_ptr != NULL && dungeon_ptr != MAP_FAILED && dungeon_ptr->running && exit_flag == 0 && spoils_count < 4) {
 
             // Check for treasure timeout
-            if (difftime(time(NULL), treasure_start_time) > TIME_TREASURE_AVAILABLE) {
+            if (deadline_passed(&treasure_deadline)) {
                  printf("[ROGUE %d] Treasure collection timed out!\n", getpid());
                  break;
             }
@@ -218,7 +363,7 @@ void rogue_signal_handler(int signum) {
 
         // Check if loop exited because all spoils collected
         if (spoils_count == 4) {
-             printf("[ROGUE %d] All spoils collected: '%s'.\n", getpid(), dungeon_ptr->spoils);
+             printf("[ROGUE %d] All spoils collected: '%.4s'.\n", getpid(), dungeon_ptr->spoils);
              // The Barbarian/Wizard should see spoils[3] != '\0' and release levers.
         } else {
              printf("[ROGUE %d] Exited treasure collection early (count=%d, running=%d, exit_flag=%d).\n",
@@ -227,134 +372,52 @@ void rogue_signal_handler(int signum) {
                    exit_flag);
         }
 
+        const struct CharacterPlugin *plugin = character_strategy(&rogue);
+        if (plugin != NULL && plugin->on_treasure != NULL) {
+            plugin->on_treasure(rogue.strategy.state, dungeon_ptr->spoils);
+        }
+
         return; // Exit semaphore handler
     } // End of SEMAPHORE_SIGNAL handling
 
-} // --- End of rogue_signal_handler ---
+} // --- End of rogue_serve ---
 
 
 /*
  * main - The main function for the Rogue process.
- * Initializes connections to shared memory and semaphores, sets the initial pick,
- * sets up signal handlers, and enters a loop to wait for signals using pause().
+ * Attaches to the dungeon, sets the initial pick and serves rooms until the dungeon
+ * finishes or we are interrupted.
  */
 int main() {
     printf("[ROGUE] Process started. PID: %d\n", getpid());
 
-    // --- 1. Connect to Shared Memory ---
-    shm_fd = shm_open(dungeon_shm_name, O_RDWR, 0666);
-    if (shm_fd == -1) {
-        error_exit("ROGUE: shm_open failed");
-    }
+    character_attach(&rogue);
+    dungeon_ptr = rogue.dungeon;
 
-    dungeon_ptr = (struct Dungeon *)mmap(NULL, sizeof(struct Dungeon), PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd, 0);
-    if (dungeon_ptr == MAP_FAILED) {
-        close(shm_fd); // Close fd before error_exit if open
-        error_exit("ROGUE: mmap failed");
-    }
-    // Close the file descriptor as it's no longer needed after mapping.
-    close(shm_fd);
-    // shm_fd = -1; // Mark as closed (optional)
-    printf("[ROGUE] Connected to shared memory.\n");
+    // --- Load Trap History ---
+    history_open();
 
     // --- Set Initial Rogue Pick and Direction ---
-    // Do this *after* mapping shared memory.
-    dungeon_ptr->rogue.pick = MAX_PICK_ANGLE / 2.0;
-    dungeon_ptr->trap.direction = 't'; // Signal initial pick is ready
-    printf("[ROGUE] Set initial pick to %.6f and direction to 't'.\n", dungeon_ptr->rogue.pick);
-
-
-    // --- 2. Connect to Semaphores ---
-    lever1_sem = sem_open(dungeon_lever_one, O_RDWR);
-    if (lever1_sem == SEM_FAILED) {
-        munmap(dungeon_ptr, sizeof(struct Dungeon)); dungeon_ptr = NULL;
-        error_exit("ROGUE: sem_open failed for lever one");
-    }
-
-    lever2_sem = sem_open(dungeon_lever_two, O_RDWR);
-    if (lever2_sem == SEM_FAILED) {
-        sem_close(lever1_sem); lever1_sem = SEM_FAILED; // Clean up first semaphore
-        munmap(dungeon_ptr, sizeof(struct Dungeon)); dungeon_ptr = NULL;
-        error_exit("ROGUE: sem_open failed for lever two");
-    }
-    printf("[ROGUE] Connected to semaphores.\n");
-
-    // --- 3. Set up Signal Handlers ---
-    struct sigaction sa; // Use one struct, reset for each signal
-
-    // Configure and register the handler for DUNGEON_SIGNAL.
-    memset(&sa, 0, sizeof(sa));
-    sa.sa_handler = rogue_signal_handler;
-    sa.sa_flags = 0; // No SA_RESTART needed with pause() loop usually
-    sigemptyset(&sa.sa_mask); // Ensure mask is clear initially
-    if (sigaction(DUNGEON_SIGNAL, &sa, NULL) == -1) {
-        // Attempt cleanup before exiting
-        sem_close(lever1_sem); sem_close(lever2_sem);
-        munmap(dungeon_ptr, sizeof(struct Dungeon));
-        error_exit("ROGUE: sigaction failed for DUNGEON_SIGNAL");
-    }
-    printf("[ROGUE] Signal handler set up for DUNGEON_SIGNAL (%d).\n", DUNGEON_SIGNAL);
-
-    // Configure and register the handler for SEMAPHORE_SIGNAL.
-    memset(&sa, 0, sizeof(sa)); // Reset struct
-    sa.sa_handler = rogue_signal_handler;
-    sa.sa_flags = 0;
-    sigemptyset(&sa.sa_mask);
-    if (sigaction(SEMAPHORE_SIGNAL, &sa, NULL) == -1) {
-        sem_close(lever1_sem); sem_close(lever2_sem);
-        munmap(dungeon_ptr, sizeof(struct Dungeon));
-        error_exit("ROGUE: sigaction failed for SEMAPHORE_SIGNAL");
-    }
-    printf("[ROGUE] Signal handler set up for SEMAPHORE_SIGNAL (%d).\n", SEMAPHORE_SIGNAL);
-
-    // Configure and register the handler for SIGINT (Ctrl+C).
-    // Using the main handler now, but could use the separate one too.
-    memset(&sa, 0, sizeof(sa));
-    sa.sa_handler = rogue_signal_handler; // Route SIGINT to main handler
-    // sa.sa_handler = sigint_handler; // Or use the dedicated simpler handler
-    sa.sa_flags = 0;
-    sigemptyset(&sa.sa_mask);
-    if (sigaction(SIGINT, &sa, NULL) == -1) {
-         perror("ROGUE: sigaction failed for SIGINT");
-         // Continue running even if SIGINT handler fails? Or exit? Let's continue.
-    }
-    printf("[ROGUE] Signal handler set up for SIGINT.\n");
-
-    // --- 4. Main Loop: Wait for Signals ---
-    printf("[ROGUE] Ready to receive signals...\n");
-
-    // Loop while the dungeon is running and exit flag is not set
-    while (dungeon_ptr != NULL && dungeon_ptr != MAP_FAILED && dungeon_ptr->running && exit_flag == 0) {
-        pause(); // Wait for any handled signal to arrive
-        // When a signal arrives, its handler will run, then pause() will return, and the loop continues.
+    // A plugin with a search chooses the first pick, as it would after unlocking a trap.
+    const struct CharacterPlugin *plugin = character_strategy(&rogue);
+    float first_pick = -1.0;
+    if (plugin != NULL && plugin->on_trap_feedback != NULL) {
+        first_pick = plugin->on_trap_feedback(rogue.strategy.state, 0.0, 'w');
     }
+    publish_pick(first_pick >= 0.0 ? first_pick : history_probe(0.0, MAX_PICK_ANGLE)); // Signal initial pick is ready
+    printf("[ROGUE] Set initial pick to %.6f and direction to 't'.\n", dungeon_ptr->rogue.pick);
 
+    character_run(&rogue);
 
     printf("[ROGUE] Dungeon simulation finished or interrupted. Exiting.\n");
 
-    // --- 5. Cleanup Resources ---
-    // Unmap shared memory.
-    if (dungeon_ptr != MAP_FAILED && dungeon_ptr != NULL) {
-        if (munmap(dungeon_ptr, sizeof(struct Dungeon)) == -1) {
-            perror("ROGUE: munmap failed");
-        }
-        dungeon_ptr = NULL;
-    }
-
-    // Close semaphore descriptors.
-    if (lever1_sem != SEM_FAILED) {
-        if (sem_close(lever1_sem) == -1) {
-            perror("ROGUE: sem_close lever1 failed");
-        }
-        lever1_sem = SEM_FAILED;
+    // Unmap the trap history; MAP_SHARED has already written it back to the file.
+    if (history != NULL) {
+        munmap(history, sizeof(struct PickHistory));
+        history = NULL;
     }
-     if (lever2_sem != SEM_FAILED) {
-        if (sem_close(lever2_sem) == -1) {
-            perror("ROGUE: sem_close lever2 failed");
-        }
-        lever2_sem = SEM_FAILED;
-    }
-
+    character_detach(&rogue);
+    dungeon_ptr = NULL;
     printf("[ROGUE] Cleanup complete. Exiting.\n");
 
     return EXIT_SUCCESS;
@@ -0,0 +1,228 @@
+/*
+ * spectator.c - Watches a game through the engine's snapshot ring.
+ * The engine (engine.c, i.e. `make DUNGEON_OBJ=engine.o`) publishes a snapshot to
+ * /DungeonSpectate every time the game changes (see dungeon_spectate.h). This process maps
+ * the ring read-only, so it never touches /DungeonMem and never slows the engine down, and
+ * any number of spectators can watch at once.
+ *
+ * By default it prints every snapshot in order, starting from the oldest one still in the
+ * ring, until the game is over. A spectator that falls more than SPECTATOR_RING_SLOTS
+ * snapshots behind skips the ones that were overwritten and counts them as missed. With -l
+ * it only shows the latest state, once per interval, as an overlay would.
+ *
+ * Usage: ./spectator [-l] [-i interval_us]
+ */
+
+// Include necessary headers for system calls and standard libraries.
+#define _XOPEN_SOURCE 700       // Ensure POSIX features are available
+#define _POSIX_C_SOURCE 200809L // Ensure POSIX.1-2008 compliance
+
+#include <stdio.h>      // For printf, perror
+#include <stdlib.h>     // For exit, atoi
+#include <unistd.h>     // For close, getpid, getopt
+#include <sys/mman.h>   // For shared memory functions (shm_open, mmap, munmap)
+#include <sys/stat.h>   // For fstat
+#include <fcntl.h>      // For file control options
+#include <signal.h>     // For sigaction, kill
+#include <stdbool.h>    // For bool type
+#include <string.h>     // For memset
+
+// Include custom header files for shared resources and settings.
+#include "dungeon_info.h"      // Defines the Dungeon struct layout
+#include "dungeon_settings.h"  // Defines game parameters
+#include "dungeon_clock.h"     // Monotonic time
+#include "dungeon_slots.h"     // For enum RoomType
+#include "dungeon_spectate.h"  // Defines the snapshot ring
+
+// Names of enum RoomType, for printing.
+static const char *const room_names[] = {"none", "enemy", "barrier", "trap", "treasure"};
+
+// --- Global Variables ---
+const struct SpectatorRing *ring = NULL; // The mapped ring, NULL until the engine creates it
+long long first_time = 0;                // Time of the first snapshot shown
+
+// Flag to control the spectator's exit, set by the SIGINT handler.
+volatile sig_atomic_t exit_flag = 0;
+
+// --- Function Definitions ---
+
+/*
+ * sigint_handler - Handles the SIGINT signal (Ctrl+C) for graceful exit.
+ * @signum: The signal number (SIGINT).
+ */
+void sigint_handler(int signum) {
+    (void)signum;
+    exit_flag = 1;
+}
+
+/*
+ * attach - Maps /DungeonSpectate once the engine has created it.
+ * Returns true if the ring is mapped.
+ */
+static bool attach(void) {
+    int fd = shm_open(DUNGEON_SPECTATE_SHM_NAME, O_RDONLY, 0);
+    if (fd == -1) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) == -1 || (size_t)info.st_size < sizeof(struct SpectatorRing)) {
+        close(fd); // The engine has not sized it yet.
+        return false;
+    }
+    void *memory = mmap(NULL, sizeof(struct SpectatorRing), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd); // The mapping stays valid after the descriptor is closed.
+    if (memory == MAP_FAILED) {
+        perror("SPECTATOR: mmap failed");
+        return false;
+    }
+    const struct SpectatorRing *mapped = (const struct SpectatorRing *)memory;
+    unsigned int layout = __atomic_load_n(&mapped->layout, __ATOMIC_ACQUIRE);
+    if (layout != DUNGEON_SPECTATE_LAYOUT) {
+        munmap(memory, sizeof(struct SpectatorRing));
+        if (layout != 0) {
+            fprintf(stderr, "SPECTATOR: /DungeonSpectate uses another layout; rebuild engine.o and spectator alike.\n");
+            exit_flag = 1;
+        }
+        return false; // Layout 0: the engine is still setting it up.
+    }
+    ring = mapped;
+    printf("[SPECTATOR] Watching the game of engine PID %d.\n", ring->engine);
+    return true;
+}
+
+/*
+ * show - Prints one snapshot.
+ */
+static void show(const struct SpectatorSnapshot *snapshot) {
+    if (first_time == 0) {
+        first_time = snapshot->time;
+    }
+    const char *room = room_names[snapshot->roomType >= 0 && snapshot->roomType <= ROOM_TREASURE ? snapshot->roomType : 0];
+    printf("[SPECTATOR] #%lu +%.3f s ", snapshot->serial, (double)(snapshot->time - first_time) / NSEC_PER_SEC);
+    switch (snapshot->event) {
+    case SPECTATE_GAME_STARTED:
+        printf("Game started.\n");
+        break;
+    case SPECTATE_ROOM_OPENED:
+        printf("Room %d (%s) opened", snapshot->room, room);
+        if (snapshot->roomType == ROOM_ENEMY) {
+            printf(": monster with %d health", snapshot->health);
+        } else if (snapshot->roomType == ROOM_BARRIER) {
+            printf(": \"%.*s\"", (int)sizeof(snapshot->barrier), snapshot->barrier);
+        } else if (snapshot->roomType == ROOM_TRAP) {
+            printf(": trap at %.1f", snapshot->trap);
+        }
+        printf(".\n");
+        break;
+    case SPECTATE_ROOM_CLOSED:
+        printf("Room %d (%s) %s", snapshot->room, room, snapshot->passed ? "won" : "lost");
+        if (snapshot->roomType == ROOM_ENEMY) {
+            printf(" with attack %d", snapshot->attack);
+        } else if (snapshot->roomType == ROOM_BARRIER) {
+            printf(" with \"%.*s\"", SPELL_BUFFER_SIZE, snapshot->spell);
+        } else if (snapshot->roomType == ROOM_TRAP) {
+            printf(" with the pick at %.1f", snapshot->pick);
+        }
+        printf(". Score %d; Wizard %d/%d, Barbarian %d/%d, Rogue %d/%d.\n", snapshot->score,
+               snapshot->wins[ROLE_WIZARD], snapshot->runs[ROLE_WIZARD], snapshot->wins[ROLE_BARBARIAN],
+               snapshot->runs[ROLE_BARBARIAN], snapshot->wins[ROLE_ROGUE], snapshot->runs[ROLE_ROGUE]);
+        break;
+    case SPECTATE_PICK_JUDGED:
+        printf("Pick at %.1f for the trap at %.1f: %c\n", snapshot->pick, snapshot->trap, snapshot->direction);
+        break;
+    case SPECTATE_TREASURE:
+        printf("Treasure revealed: %.4s\n", snapshot->treasure);
+        break;
+    case SPECTATE_GAME_OVER:
+        printf("Game over. Score %d.\n", snapshot->score);
+        break;
+    default:
+        printf("Unknown event %d.\n", snapshot->event);
+        break;
+    }
+}
+
+/*
+ * engine_gone - Returns true if the engine process has exited.
+ */
+static bool engine_gone(void) {
+    return kill(ring->engine, 0) == -1;
+}
+
+/*
+ * main - Waits for the ring, then follows it (or shows the latest state with -l) until the game ends.
+ */
+int main(int argc, char *argv[]) {
+    bool latest_only = false;
+    long long interval = SPECTATOR_POLL;
+    int option;
+    while ((option = getopt(argc, argv, "li:")) != -1) {
+        switch (option) {
+        case 'l': latest_only = true; break;
+        case 'i': interval = atoll(optarg); break;
+        default:
+            fprintf(stderr, "Usage: %s [-l] [-i interval_us]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (interval <= 0) {
+        fprintf(stderr, "SPECTATOR: the interval must be positive.\n");
+        return EXIT_FAILURE;
+    }
+
+    struct sigaction sa_sigint;
+    memset(&sa_sigint, 0, sizeof(sa_sigint));
+    sa_sigint.sa_handler = sigint_handler;
+    if (sigaction(SIGINT, &sa_sigint, NULL) == -1) {
+        perror("SPECTATOR: sigaction failed for SIGINT");
+    }
+
+    printf("[SPECTATOR] Process started. PID: %d\n", getpid());
+    printf("[SPECTATOR] Waiting for a game...\n");
+    while (exit_flag == 0 && !attach()) {
+        clock_sleep(interval * NSEC_PER_USEC);
+    }
+    if (ring == NULL) {
+        return exit_flag ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    // Start from the oldest snapshot that is still in the ring.
+    unsigned long head = spectate_head(ring);
+    unsigned long next = head > SPECTATOR_RING_SLOTS ? head - SPECTATOR_RING_SLOTS : 0;
+    unsigned long seen = 0, missed = 0;
+    bool over = false;
+    struct SpectatorSnapshot snapshot;
+    while (exit_flag == 0 && !over) {
+        head = spectate_head(ring);
+        if (latest_only && head > 0 && head - 1 > next) {
+            missed += head - 1 - next; // Skipped on purpose, not lost.
+            next = head - 1;
+        }
+        while (next < head && !over) {
+            int result = spectate_read(ring, next, &snapshot);
+            if (result == 1) {
+                break; // Still being written.
+            }
+            if (result == -1) {
+                missed++; // Overwritten before it could be read.
+            } else {
+                show(&snapshot);
+                seen++;
+                over = snapshot.event == SPECTATE_GAME_OVER;
+            }
+            next++;
+        }
+        if (!over && next == spectate_head(ring) && engine_gone()) {
+            printf("[SPECTATOR] The engine exited without finishing the game.\n");
+            break;
+        }
+        if (!over) {
+            clock_sleep(interval * NSEC_PER_USEC);
+        }
+    }
+    printf("[SPECTATOR] Showed %lu snapshots, %s %lu.\n", seen, latest_only ? "skipped" : "missed", missed);
+
+    munmap((void *)ring, sizeof(struct SpectatorRing));
+    printf("[SPECTATOR] Cleanup complete. Exiting.\n");
+    return EXIT_SUCCESS;
+}